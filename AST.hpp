@@ -1,11 +1,17 @@
 #ifndef _SNARKFRONT_AST_HPP_
 #define _SNARKFRONT_AST_HPP_
 
+#include <cassert>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <snarkfront/BlockPool.hpp>
 #include <snarkfront/Lazy.hpp>
+#include <snarkfront/TLsingleton.hpp>
 
 namespace snarkfront {
 
@@ -17,6 +23,8 @@ template <typename ALG> class AST_Const;
 template <typename ALG> class AST_Var;
 template <typename ALG> class AST_Op;
 template <typename ALG> class AST_X;
+template <typename ALG, typename L, typename R> class AST_Expr;
+template <typename ALG> class EvalAST;
 
 // visitor pattern
 template <typename ALG>
@@ -29,6 +37,11 @@ public:
     virtual void visit(const AST_Var<ALG>&) = 0;
     virtual void visit(const AST_Op<ALG>&) = 0;
     virtual void visit(const AST_X<ALG>&) = 0;
+
+    // expression templates are evaluated inline, not visited
+    virtual EvalAST<ALG>* evaluator() {
+        return nullptr;
+    }
 };
 
 // abstract syntax tree nodes
@@ -39,6 +52,24 @@ public:
     virtual ~AST_Node() = default;
 
     virtual void accept(VisitAST<ALG>&) const = 0;
+
+    // operator node, evaluation follows chains of them without recursion
+    virtual const AST_Op<ALG>* asOp() const {
+        return nullptr;
+    }
+
+    // argument of an operator, counted if it is an expression template
+    // (may be an argument of several operators)
+    virtual void shareArg(EvalAST<ALG>&) const {}
+
+    // nodes made with new come from the thread local block pool
+    static void* operator new(std::size_t n) {
+        return TL<BlockPool>::singleton()->allocate(n);
+    }
+
+    static void operator delete(void* p, std::size_t n) {
+        TL<BlockPool>::singleton()->deallocate(p, n);
+    }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -84,57 +115,80 @@ class AST_Op : public AST_Node<ALG>
     typedef typename ALG::OpType OP;
 
 public:
-    AST_Op() = default;
+    AST_Op()
+        : m_links{nullptr, nullptr},
+          m_deleteLeft(false),
+          m_deleteRight(false),
+          m_evalRefs(0),
+          m_evalShared(false)
+    {}
 
+    // unary operator links to the same node on both sides
     AST_Op(const OP op, const AST_Node<ALG>& a)
-        : m_opType(op)
-    {
-        m_links.push_back(std::addressof(a));
-    }
+        : AST_Op{op, a, a}
+    {}
 
     AST_Op(const OP op, const AST_Node<ALG>* a)
         : AST_Op{op, *a}
     {
-        m_delete.push_back(a);
+        m_deleteLeft = true;
     }
 
     AST_Op(const OP op, const AST_Node<ALG>& a, const AST_Node<ALG>& b)
-        : AST_Op{op, a}
-    {
-        m_links.push_back(std::addressof(b));
-    }
+        : m_opType(op),
+          m_links{std::addressof(a), std::addressof(b)},
+          m_deleteLeft(false),
+          m_deleteRight(false),
+          m_evalRefs(0),
+          m_evalShared(false)
+    {}
 
     AST_Op(const OP op, const AST_Node<ALG>& a, const AST_Node<ALG>* b)
         : AST_Op{op, a, *b}
     {
-        m_delete.push_back(b);
+        m_deleteRight = true;
     }
 
     AST_Op(const OP op, const AST_Node<ALG>* a, const AST_Node<ALG>& b)
         : AST_Op{op, *a, b}
     {
-        m_delete.push_back(a);
+        m_deleteLeft = true;
     }
 
     AST_Op(const OP op, const AST_Node<ALG>* a, const AST_Node<ALG>* b)
         : AST_Op{op, a, *b}
     {
-        m_delete.push_back(b);
+        // same node on both sides, e.g. x * x
+        m_deleteRight = (a != b);
     }
 
     virtual ~AST_Op() {
-        for (const auto& p : m_delete)
-            delete p;
+        if (m_deleteLeft) delete leftLink();
+        if (m_deleteRight) delete rightLink();
     }
 
     void accept(VisitAST<ALG>& a) const {
         a.visit(*this);
     }
 
+    const AST_Op* asOp() const {
+        return this;
+    }
+
     void descendLeft(VisitAST<ALG>& a) const {
         leftLink()->accept(a);
     }
 
+    // first argument if it is an operator, else null
+    const AST_Op* leftOp() const {
+        return leftLink()->asOp();
+    }
+
+    // second argument if it is an operator, else null
+    const AST_Op* rightOp() const {
+        return rightLink()->asOp();
+    }
+
     void descendRight(VisitAST<ALG>& a) const {
         rightLink()->accept(a);
     }
@@ -145,19 +199,93 @@ public:
 
 private:
     const AST_Node<ALG>* leftLink() const {
-        return m_links.front();
+        return m_links[0];
     }
 
     const AST_Node<ALG>* rightLink() const {
-        return m_links.back();
+        return m_links[1];
     }
 
+    // links are inline, no allocation beyond the node itself
     OP m_opType;
-    std::vector<const AST_Node<ALG>*> m_links, m_delete;
+    const AST_Node<ALG>* m_links[2];
+    bool m_deleteLeft, m_deleteRight;
+
+    // references from the tree being evaluated (zero when idle)
+    friend class EvalAST<ALG>;
+    mutable std::size_t m_evalRefs;
+    mutable bool m_evalShared;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// expression templates
+//
+// Operators on variables, constants, and other expressions make nodes
+// with the shape of the expression in the type, e.g. a ^ (b & c) is an
+// XOR node of a variable and an AND node. The evaluator walks these
+// with inlined code. The node is still an AST_Node so anything built at
+// runtime can link to it.
+//
+// L and R are how arguments are held. Lvalues (variables, constants,
+// named expressions) are linked by reference and temporaries are copied
+// in by value. Named expressions may be used more than once.
+//
+
+// unary operator has no second argument
+struct ExprNone {};
+
+template <typename X>
+struct ExprLink { typedef typename std::decay<X>::type type; };
+
+template <typename X>
+struct ExprLink<X&> { typedef const typename std::decay<X>::type& type; };
+
+template <typename ALG, typename L, typename R>
+class AST_Expr : public AST_Node<ALG>
+{
+    typedef typename ALG::OpType OP;
+
+public:
+    template <typename X, typename Y>
+    AST_Expr(const OP op, X&& a, Y&& b)
+        : m_opType(op),
+          m_left(std::forward<X>(a)),
+          m_right(std::forward<Y>(b))
+    {}
+
+    void accept(VisitAST<ALG>& a) const {
+        const auto E = a.evaluator();
+#ifdef USE_ASSERT
+        assert(E);
+#endif
+        E->visit(*this);
+    }
+
+    void shareArg(EvalAST<ALG>& E) const {
+        E.shareNamed(*this);
+    }
+
+    const typename std::decay<L>::type& left() const {
+        return m_left;
+    }
+
+    const typename std::decay<R>::type& right() const {
+        return m_right;
+    }
+
+    OP opType() const {
+        return m_opType;
+    }
+
+private:
+    OP m_opType;
+    L m_left;
+    R m_right;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 // foreign tree - comparison and type conversion
+// (also results of gadgets evaluated when the node is made)
 //
 
 template <typename ALG>
@@ -194,6 +322,11 @@ public:
         : m_alg(ALG_OTHER::xwordOp(a, m_alg))
     {}
 
+    // gadget result, e.g. table look-up
+    explicit AST_X(ALG a)
+        : m_alg(std::move(a))
+    {}
+
     explicit operator bool() const {
         return bool(m_alg);
     }
@@ -256,6 +389,12 @@ public:
         : m_alg(ALG::assignEval(*this, rhs))
     {}
 
+    // assignment case at point of declaration
+    template <typename L, typename R>
+    AST_Var(const AST_Expr<ALG, L, R>& rhs)
+        : m_alg(ALG::assignEval(*this, rhs))
+    {}
+
     // circuit input
     template <typename VAL>
     void bless(const VAL& a) {
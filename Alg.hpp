@@ -5,17 +5,20 @@
 #include <cstdint>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <snarklib/BigInt.hpp>
 #include <snarklib/Rank1DSL.hpp>
 
+#include <snarkfront/AlgStorage.hpp>
 #include <snarkfront/AST.hpp>
 #include <snarkfront/EnumOps.hpp>
 #include <snarkfront/EvalAST.hpp>
 #include <snarkfront/PowersOf2.hpp>
 #include <snarkfront/R1C.hpp>
 #include <snarkfront/TLsingleton.hpp>
+#include <snarkfront/WitnessValue.hpp>
 
 namespace snarkfront {
 
@@ -45,19 +48,19 @@ template <typename FR> using
 Alg_uint8 = Alg<std::uint8_t,
                 FR,
                 BitwiseOps,
-                EqualityCmp>;
+                ScalarCmp>;
 
 template <typename FR> using
 Alg_uint32 = Alg<std::uint32_t,
                  FR,
                  BitwiseOps,
-                 EqualityCmp>;
+                 ScalarCmp>;
 
 template <typename FR> using
 Alg_uint64 = Alg<std::uint64_t,
                  FR,
                  BitwiseOps,
-                 EqualityCmp>;
+                 ScalarCmp>;
 
 template <typename FR> using
 Alg_BigInt = Alg<snarklib::BigInt<2>, // N = 2 is 128 bits on x86-64
@@ -111,6 +114,10 @@ public:
     typedef snarklib::R1Term<FR> R1T;
     typedef snarklib::R1Variable<FR> R1V;
 
+    // packed and inline for fixed width types, else vectors
+    typedef typename AlgStorage<VAL, R1T>::Bits Bits;
+    typedef typename AlgStorage<VAL, R1T>::Terms Terms;
+
     Alg() = default;
 
     // circuit input
@@ -123,8 +130,8 @@ public:
 #endif
 
         m_value = VAL(a);
-        m_witness = FR(valueToString(VAL(a)));
-        m_splitBits = valueBits(VAL(a));
+        m_witness = valueToField(VAL(a));
+        m_splitBits = splitValue(VAL(a));
 
         initTerms(true);
     }
@@ -138,8 +145,8 @@ public:
     template <typename T>
     Alg(const T& a, const bool blessed)
         : m_value(a),
-          m_witness(valueToString(VAL(a))),
-          m_splitBits(valueBits(VAL(a)))
+          m_witness(valueToField(VAL(a))),
+          m_splitBits(splitValue(VAL(a)))
     {
         initTerms(blessed);
     }
@@ -150,14 +157,15 @@ public:
     {}
 
     // used by operator evaluation and conversion blessing
+    // (moved in when the caller is done with them)
     Alg(const VAL& a,
         const FR& b,
-        const std::vector<int>& c,
-        const std::vector<R1T>& d)
+        Bits c,
+        Terms d)
         : m_value(a),
           m_witness(b),
-          m_splitBits(c),
-          m_r1Terms(d)
+          m_splitBits(std::move(c)),
+          m_r1Terms(std::move(d))
     {}
 
     explicit operator bool() const {
@@ -175,18 +183,23 @@ public:
     }
 
     // bits for witness split
-    const std::vector<int>& splitBits() const {
+    const Bits& splitBits() const {
         return m_splitBits;
     }
 
     // return constraint terms for bit representation
-    const std::vector<R1T>& r1Terms() const {
+    const Terms& r1Terms() const {
         return m_r1Terms;
     }
 
-    // field constructors accept strings
-    static std::string valueToString(const VAL& a) {
-        return snarkfront::valueToString(a);
+    // bits of a value
+    static Bits splitValue(const VAL& a) {
+        return AlgStorage<VAL, R1T>::splitValue(a);
+    }
+
+    // field element of value, converted in binary
+    static FR valueToField(const VAL& a) {
+        return snarkfront::valueToField<FR>(a);
     }
 
     // called from AST Variable overloaded assignment operator
@@ -194,7 +207,15 @@ public:
     assignEval(const AST_Var<Alg>& lhs, const AST_Node<Alg>& rhs) {
         EvalAST<Alg> E;
         rhs.accept(E);
-        return E.result();
+        return E.takeResult();
+    }
+
+    template <typename L, typename R>
+    static Alg
+    assignEval(const AST_Var<Alg>& lhs, const AST_Expr<Alg, L, R>& rhs) {
+        EvalAST<Alg> E;
+        E.visit(rhs);
+        return E.takeResult();
     }
 
     static Alg
@@ -206,25 +227,25 @@ public:
     static Alg_bool<FR>
     compareOp(const CMP op, const AST_Node<Alg>& a, const AST_Node<Alg>& b)
     {
-        // evaluate left and right hand side nodes
-        EvalAST<Alg> A, B;
-        a.accept(A);
-        b.accept(B);
-
-        // push left and right hand side results on stack
-        EvalAST<Alg> C;
-        C.push(A.result());
-        C.push(B.result());
+        // left and right hand side results are on the stack in order,
+        // operators shared by both sides are evaluated once
+        EvalAST<Alg> E;
+        E.share(a);
+        E.share(b);
+        a.accept(E);
+        b.accept(E);
 
         // evaluate comparison operation
-        C.compareOp(op);
+        E.compareOp(op);
 
         // convert comparison result of foreign algebraic type to predicate
-        const bool result = bool(C.result());
+        const Alg C = E.takeResult();
+        const bool result = bool(C);
         return Alg_bool<FR>(result,
                             boolTo<FR>(result),
-                            valueBits(result),
-                            C.result().r1Terms());
+                            Alg_bool<FR>::splitValue(result),
+                            typename Alg_bool<FR>::Terms(C.r1Terms().begin(),
+                                                         C.r1Terms().end()));
     }
 
     // conversion from bool to 8-bit, 32-bit, 64-bit unsigned word bitmasks
@@ -270,8 +291,8 @@ public:
 
         // convert result of foreign algebraic source type to target type
         return U(uvalue,
-                 valueToString(uvalue),
-                 valueBits(uvalue),
+                 U::valueToField(uvalue),
+                 U::splitValue(uvalue),
                  rank1_xword(x, returnSize));
     }
 
@@ -279,16 +300,12 @@ private:
     VAL valueFromWitness(const R1Cowitness<FR>& input) const {
         const std::size_t peekID = TL<R1C<FR>>::singleton()->counterID();
 #ifdef USE_ASSERT
-        assert(peekID <= input.sizeSTR());
+        assert(peekID <= input.sizeValues());
+        assert(! input[peekID].empty());
 #endif
 
-        std::stringstream ss(input[peekID]);
-
         VAL value;
-        ss >> value;
-#ifdef USE_ASSERT
-        assert(!!ss);
-#endif
+        input[peekID].get(value);
 
         return value;
     }
@@ -319,8 +336,8 @@ private:
 
     VAL m_value;
     FR m_witness;
-    std::vector<int> m_splitBits;
-    std::vector<R1T> m_r1Terms;
+    Bits m_splitBits;
+    Terms m_r1Terms;
 };
 
 } // namespace snarkfront
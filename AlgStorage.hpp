@@ -0,0 +1,309 @@
+#ifndef _SNARKFRONT_ALG_STORAGE_HPP_
+#define _SNARKFRONT_ALG_STORAGE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <snarkfront/PowersOf2.hpp>
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// split bits packed into machine words
+//
+// Same interface as the std::vector<int> it replaces for fixed width
+// types. Capacity N covers overflow bits from modulo arithmetic. Unlike
+// the vector it can not grow, so going past N throws std::length_error
+// in every build (not only with USE_ASSERT).
+//
+
+template <std::size_t N>
+class PackedBits
+{
+public:
+    class const_iterator
+    {
+    public:
+        const_iterator(const PackedBits* a, const std::size_t i)
+            : m_a(a), m_i(i)
+        {}
+
+        int operator* () const { return (*m_a)[m_i]; }
+        const_iterator& operator++ () { ++m_i; return *this; }
+        bool operator!= (const const_iterator& b) const { return m_i != b.m_i; }
+
+    private:
+        const PackedBits* m_a;
+        std::size_t m_i;
+    };
+
+    PackedBits()
+        : m_size(0)
+    {
+        m_words.fill(0);
+    }
+
+    // low n bits of a word
+    PackedBits(const std::uint64_t a, const std::size_t n)
+        : PackedBits{}
+    {
+        if (n > 64 || n > N)
+            throw std::length_error("PackedBits: too many bits");
+
+        m_words[0] = (64 == n) ? a : a & ((std::uint64_t(1) << n) - 1);
+        m_size = n;
+    }
+
+    PackedBits(const std::vector<int>& a)
+        : PackedBits{}
+    {
+        for (const auto& b : a) push_back(b);
+    }
+
+    operator std::vector<int> () const {
+        std::vector<int> v;
+        v.reserve(m_size);
+        for (std::size_t i = 0; i < m_size; ++i) v.push_back((*this)[i]);
+        return v;
+    }
+
+    bool operator== (const std::vector<int>& a) const {
+        if (a.size() != m_size) return false;
+        for (std::size_t i = 0; i < m_size; ++i) {
+            if (bool(a[i]) != bool((*this)[i])) return false;
+        }
+
+        return true;
+    }
+
+    int operator[] (const std::size_t i) const {
+        return (m_words[i / 64] >> (i % 64)) & 0x1;
+    }
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return 0 == m_size; }
+
+    void reserve(const std::size_t) {}
+
+    void push_back(const int b) {
+        if (m_size >= N)
+            throw std::length_error("PackedBits: capacity exceeded");
+
+        if (b) m_words[m_size / 64] |= std::uint64_t(1) << (m_size % 64);
+        ++m_size;
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_size); }
+
+private:
+    std::array<std::uint64_t, (N + 63) / 64> m_words;
+    std::size_t m_size;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// constraint terms, the first N stored inline
+//
+// Results with more than N terms move them all to the heap, so only
+// small results (scalar arithmetic, one term) avoid allocating.
+//
+
+template <typename T, std::size_t N>
+class InlineTerms
+{
+public:
+    InlineTerms()
+        : m_size(0)
+    {}
+
+    InlineTerms(std::initializer_list<T> a)
+        : InlineTerms{}
+    {
+        for (const auto& b : a) push_back(b);
+    }
+
+    InlineTerms(const std::vector<T>& a)
+        : InlineTerms{a.begin(), a.end()}
+    {}
+
+    template <typename IT>
+    InlineTerms(IT first, IT last)
+        : InlineTerms{}
+    {
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    InlineTerms(const InlineTerms& other)
+        : InlineTerms{}
+    {
+        reserve(other.size());
+        for (const auto& b : other) push_back(b);
+    }
+
+    InlineTerms(InlineTerms&& other)
+        : InlineTerms{}
+    {
+        moveFrom(other);
+    }
+
+    ~InlineTerms() {
+        clear();
+    }
+
+    InlineTerms& operator= (const InlineTerms& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size());
+            for (const auto& b : other) push_back(b);
+        }
+
+        return *this;
+    }
+
+    InlineTerms& operator= (InlineTerms&& other) {
+        if (this != &other) {
+            clear();
+            moveFrom(other);
+        }
+
+        return *this;
+    }
+
+    operator std::vector<T> () const {
+        return std::vector<T>(begin(), end());
+    }
+
+    const T& operator[] (const std::size_t i) const { return begin()[i]; }
+
+    std::size_t size() const { return onHeap() ? m_heap.size() : m_size; }
+    bool empty() const { return 0 == size(); }
+
+    void reserve(const std::size_t n) {
+        if (n > N) spill(n);
+    }
+
+    void push_back(const T& a) {
+        emplace_back(a);
+    }
+
+    void push_back(T&& a) {
+        emplace_back(std::move(a));
+    }
+
+    template <typename... ARGS>
+    void emplace_back(ARGS&&... args) {
+        if (! onHeap() && m_size < N) {
+            new (inlineData() + m_size) T(std::forward<ARGS>(args)...);
+            ++m_size;
+
+        } else {
+            // arguments may refer to an inline term
+            T a(std::forward<ARGS>(args)...);
+            spill(2 * N);
+            m_heap.emplace_back(std::move(a));
+        }
+    }
+
+    void clear() {
+        for (std::size_t i = 0; i < m_size; ++i) inlineData()[i].~T();
+        m_size = 0;
+        m_heap.clear();
+    }
+
+    T* begin() { return onHeap() ? m_heap.data() : inlineData(); }
+    T* end() { return begin() + size(); }
+    const T* begin() const { return onHeap() ? m_heap.data() : inlineData(); }
+    const T* end() const { return begin() + size(); }
+
+private:
+    bool onHeap() const { return ! m_heap.empty(); }
+
+    T* inlineData() { return reinterpret_cast<T*>(m_data); }
+    const T* inlineData() const { return reinterpret_cast<const T*>(m_data); }
+
+    // move inline terms to the heap
+    void spill(const std::size_t n) {
+        m_heap.reserve(std::max(n, m_size));
+        if (onHeap()) return;
+
+        for (std::size_t i = 0; i < m_size; ++i) {
+            m_heap.emplace_back(std::move(inlineData()[i]));
+            inlineData()[i].~T();
+        }
+
+        m_size = 0;
+    }
+
+    // heap terms change owner without copying
+    void moveFrom(InlineTerms& other) {
+        if (other.onHeap()) {
+            m_heap.swap(other.m_heap);
+        } else {
+            for (std::size_t i = 0; i < other.m_size; ++i)
+                push_back(std::move(other.inlineData()[i]));
+        }
+
+        other.clear();
+    }
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type m_data[N];
+    std::size_t m_size;
+    std::vector<T> m_heap;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// storage for split bits and terms in Alg
+//
+// Fixed width types have sizes known at compile time. Modulo
+// multiplication results carry 2 * N split bits (high word), modulo
+// addition N plus carry bits (re-split before the carry reaches N) and
+// selected values the wider carry of the two. These have one term,
+// stored inline. Bitwise results have N bits and N terms on the heap.
+//
+
+template <std::size_t N, typename R1T>
+struct FixedStorage
+{
+    typedef PackedBits<2 * N> Bits;
+    typedef InlineTerms<R1T, 1> Terms;
+
+    template <typename VAL>
+    static Bits splitValue(const VAL& a) {
+        return Bits(std::uint64_t(a), N);
+    }
+};
+
+// BigInt and Field
+template <typename VAL, typename R1T>
+struct AlgStorage
+{
+    typedef std::vector<int> Bits;
+    typedef std::vector<R1T> Terms;
+
+    static Bits splitValue(const VAL& a) {
+        return valueBits(a);
+    }
+};
+
+template <typename R1T>
+struct AlgStorage<bool, R1T> : public FixedStorage<1, R1T> {};
+
+template <typename R1T>
+struct AlgStorage<std::uint8_t, R1T> : public FixedStorage<8, R1T> {};
+
+template <typename R1T>
+struct AlgStorage<std::uint32_t, R1T> : public FixedStorage<32, R1T> {};
+
+template <typename R1T>
+struct AlgStorage<std::uint64_t, R1T> : public FixedStorage<64, R1T> {};
+
+} // namespace snarkfront
+
+#endif
@@ -13,12 +13,12 @@ namespace snarkfront {
 //
 
 template <typename FR>
-void evalStackOp(std::stack<Alg_Field<FR>>& S, const FieldOps op) {
+void evalStackOp(EvalStack<Alg_Field<FR>>& S, const FieldOps op) {
     evalStackOp_Field<Alg_Field<FR>>(S, op);
 }
 
 template <typename FR>
-void evalStackCmp(std::stack<Alg_Field<FR>>& S, const EqualityCmp op) {
+void evalStackCmp(EvalStack<Alg_Field<FR>>& S, const EqualityCmp op) {
     evalStackCmp_Equality(S, op);
 }
 
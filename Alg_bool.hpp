@@ -2,6 +2,7 @@
 #define _SNARKFRONT_ALG_BOOL_HPP_
 
 #include <cassert>
+#include <utility>
 
 #include <snarkfront/Alg.hpp>
 
@@ -12,13 +13,13 @@ namespace snarkfront {
 //
 
 template <typename FR>
-void evalStackOp(std::stack<Alg_bool<FR>>& S, const LogicalOps op)
+void evalStackOp(EvalStack<Alg_bool<FR>>& S, const LogicalOps op)
 {
     typedef typename Alg_bool<FR>::R1T R1T;
     auto& RS = TL<R1C<FR>>::singleton();
 
     // y is right argument
-    const auto R = S.top();
+    const auto R = std::move(S.top());
     S.pop();
     const bool yvalue = R.value();
 #ifdef USE_ASSERT
@@ -39,7 +40,7 @@ void evalStackOp(std::stack<Alg_bool<FR>>& S, const LogicalOps op)
 
     } else {
         // x is left argument
-        const auto L = S.top();
+        const auto L = std::move(S.top());
         S.pop();
         const bool xvalue = L.value();
 #ifdef USE_ASSERT
@@ -96,23 +97,23 @@ void evalStackOp(std::stack<Alg_bool<FR>>& S, const LogicalOps op)
     }
 
     S.push(
-        Alg_bool<FR>(zvalue, zwitness, valueBits(zvalue), {z}));
+        Alg_bool<FR>(zvalue, zwitness, Alg_bool<FR>::splitValue(zvalue), {z}));
 }
 
 template <typename FR>
-void evalStackCmp(std::stack<Alg_bool<FR>>& S, const EqualityCmp op)
+void evalStackCmp(EvalStack<Alg_bool<FR>>& S, const EqualityCmp op)
 {
     typedef typename Alg_bool<FR>::R1T R1T;
     auto& RS = TL<R1C<FR>>::singleton();
 
     // y is right argument
-    const auto R = S.top();
+    const auto R = std::move(S.top());
     S.pop();
     const bool yvalue = R.value();
     const R1T y = RS->argScalar(R);
 
     // x is left argument
-    const auto L = S.top();
+    const auto L = std::move(S.top());
     S.pop();
     const bool xvalue = L.value();
     const R1T x = RS->argScalar(L);
@@ -123,7 +124,7 @@ void evalStackCmp(std::stack<Alg_bool<FR>>& S, const EqualityCmp op)
     const R1T z = RS->createResult(eqToLogical(op), x, y, zwitness);
 
     S.push(
-        Alg_bool<FR>(zvalue, zwitness, valueBits(zvalue), {z}));
+        Alg_bool<FR>(zvalue, zwitness, Alg_bool<FR>::splitValue(zvalue), {z}));
 }
 
 } // namespace snarkfront
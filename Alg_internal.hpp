@@ -3,7 +3,7 @@
 
 #include <cassert>
 #include <cstdint>
-#include <stack>
+#include <utility>
 #include <vector>
 
 #include <snarkfront/Alg.hpp>
@@ -18,7 +18,7 @@ namespace snarkfront {
 //
 
 template <typename ALG, typename OPS>
-void evalStackOp_internal(std::stack<ALG>& S, const OPS op)
+void evalStackOp_internal(EvalStack<ALG>& S, const OPS op)
 {
     typedef typename ALG::ValueType Value;
     typedef typename ALG::FrType Fr;
@@ -26,14 +26,14 @@ void evalStackOp_internal(std::stack<ALG>& S, const OPS op)
     auto& RS = TL<R1C<Fr>>::singleton();
 
     // y is right argument
-    const auto R = S.top();
+    const auto R = std::move(S.top());
     S.pop();
     const Value yvalue = R.value();
     const Fr ywitness = R.witness();
     const R1T y = RS->argScalar(R);
 
     // x is left argument
-    const auto L = S.top();
+    const auto L = std::move(S.top());
     S.pop();
     const Value xvalue = L.value();
     const Fr xwitness = L.witness();
@@ -45,79 +45,151 @@ void evalStackOp_internal(std::stack<ALG>& S, const OPS op)
     const R1T z = RS->createResult(op, x, y, zwitness);
 
     S.push(
-        ALG(zvalue, zwitness, valueBits(zvalue), {z}));
+        ALG(zvalue, zwitness, ALG::splitValue(zvalue), {z}));
 }
 
 template <typename ALG>
-void evalStackOp_Scalar(std::stack<ALG>& S, const ScalarOps op) {
+void evalStackOp_Scalar(EvalStack<ALG>& S, const ScalarOps op) {
     evalStackOp_internal(S, op);
 }
 
 template <typename ALG>
-void evalStackOp_Field(std::stack<ALG>& S, const FieldOps op) {
-    evalStackOp_internal2(S, op);
+void evalStackOp_Field(EvalStack<ALG>& S, const FieldOps op)
+{
+    if (FieldOps::INV != op) {
+        evalStackOp_internal(S, op);
+        return;
+    }
+
+    typedef typename ALG::ValueType Value;
+    typedef typename ALG::FrType Fr;
+    typedef typename ALG::R1T R1T;
+    auto& RS = TL<R1C<Fr>>::singleton();
+
+    // y is only argument
+    const auto R = std::move(S.top());
+    S.pop();
+    const Value yvalue = R.value();
+    const Fr ywitness = R.witness();
+    const R1T y = RS->argScalar(R);
+
+    // z is result
+    const Value zvalue = evalOp(op, yvalue, yvalue);
+    const Fr zwitness = evalOp(op, ywitness, ywitness);
+    const R1T z = RS->createResult(op, y, y, zwitness);
+
+    S.push(
+        ALG(zvalue, zwitness, ALG::splitValue(zvalue), {z}));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // used by:
 // - Alg_Field
+//
+
+template <typename ALG>
+void evalStackCmp_Equality(EvalStack<ALG>& S, const EqualityCmp op)
+{
+    typedef typename ALG::ValueType Value;
+    typedef typename ALG::FrType Fr;
+    typedef typename ALG::R1T R1T;
+    auto& RS = TL<R1C<Fr>>::singleton();
+
+    // y is right argument
+    const auto R = std::move(S.top());
+    S.pop();
+    const Value yvalue = R.value();
+    const R1T y = RS->argPacked(R);
+
+    // x is left argument
+    const auto L = std::move(S.top());
+    S.pop();
+    const Value xvalue = L.value();
+    const R1T x = RS->argPacked(L);
+
+    // z is result
+    const bool result = evalOp(op, xvalue, yvalue);
+    const Value zvalue = boolTo<Value>(result);
+
+    // compare scalars, one constraint (equal) or two (not equal) for
+    // any width
+    const R1T z = EqualityCmp::EQ == op
+        ? RS->declarative_EQ(x, y) // must be same
+        : RS->imperative_NEQ(x, y, ALG::valueToField(xvalue) - ALG::valueToField(yvalue));
+
+    S.push(
+        ALG(zvalue, boolTo<Fr>(result), ALG::splitValue(zvalue), {z}));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// used by:
+// - Alg_BigInt
 // - Alg_uint8
 // - Alg_uint32
 // - Alg_uint64
 //
 
 template <typename ALG>
-void evalStackCmp_Equality(std::stack<ALG>& S, const EqualityCmp op)
+void evalStackCmp_Scalar(EvalStack<ALG>& S, const ScalarCmp op)
 {
     typedef typename ALG::ValueType Value;
     typedef typename ALG::FrType Fr;
     typedef typename ALG::R1T R1T;
     auto& RS = TL<R1C<Fr>>::singleton();
-    auto& POW2 = TL<PowersOf2<Fr>>::singleton();
 
     // y is right argument
-    const auto R = S.top();
+    const auto R = std::move(S.top());
     S.pop();
     const Value yvalue = R.value();
-    const std::vector<int> ybits = R.splitBits();
-    const std::vector<R1T> y = RS->argBits(R);
-
-#ifdef USE_ASSERT
-    assert(y.size() >= sizeBits(yvalue));
-#endif
+    const R1T y = RS->argPacked(R);
 
     // x is left argument
-    const auto L = S.top();
+    const auto L = std::move(S.top());
     S.pop();
     const Value xvalue = L.value();
-    const std::vector<int> xbits = L.splitBits();
-    const std::vector<R1T> x = RS->argBits(L);
-
-#ifdef USE_ASSERT
-    assert(x.size() >= sizeBits(xvalue));
-#endif
-
-    // intermediate constraint variables for each bit
-    std::vector<R1T> zvec;
-    std::vector<int> zwitness;
-    zvec.reserve(sizeBits(yvalue));
-    zwitness.reserve(sizeBits(yvalue));
-    for (std::size_t i = 0; i < sizeBits(yvalue); ++i) {
-        const bool b = evalOp(op, xbits[i], ybits[i]);
-        zwitness.push_back(b);
-        zvec.emplace_back(
-            RS->createResult(eqToLogical(op), x[i], y[i], boolTo<Fr>(b)));
-    }
+    const R1T x = RS->argPacked(L);
 
     // z is result
     const bool result = evalOp(op, xvalue, yvalue);
     const Value zvalue = boolTo<Value>(result);
-    const R1T z = EqualityCmp::EQ == op
-        ? RS->declarative_AND(zvec) // all must be same
-        : RS->imperative_OR(zvec, zwitness); // one must be different
+
+    const Fr
+        ywitness = ALG::valueToField(yvalue),
+        xwitness = ALG::valueToField(xvalue);
+
+    R1T z;
+
+    switch (op) {
+    case (ScalarCmp::EQ) :
+        // compare scalars, one constraint for any width
+        z = RS->declarative_EQ(x, y); // must be same
+        break;
+
+    case (ScalarCmp::NEQ) :
+        z = RS->imperative_NEQ(x, y, xwitness - ywitness);
+        break;
+
+    // ordering is the high bit of 2^N + x - y (or 2^N + x - y - 1 if
+    // strict) as x and y are less than 2^N, one split of N + 1 bits
+    case (ScalarCmp::LT) : // same as GT with interchanged x and y
+        z = RS->imperative_GE(y, x, ywitness, xwitness, sizeBits(xvalue), true);
+        break;
+
+    case (ScalarCmp::LE) : // same as GE with interchanged x and y
+        z = RS->imperative_GE(y, x, ywitness, xwitness, sizeBits(xvalue), false);
+        break;
+
+    case (ScalarCmp::GT) :
+        z = RS->imperative_GE(x, y, xwitness, ywitness, sizeBits(xvalue), true);
+        break;
+
+    case (ScalarCmp::GE) :
+        z = RS->imperative_GE(x, y, xwitness, ywitness, sizeBits(xvalue), false);
+        break;
+    }
 
     S.push(
-        ALG(zvalue, boolTo<Fr>(result), valueBits(zvalue), {z}));
+        ALG(zvalue, boolTo<Fr>(result), ALG::splitValue(zvalue), {z}));
 }
 
 } // namespace snarkfront
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <utility>
 
 #include <snarkfront/Alg.hpp>
 #include <snarkfront/Alg_internal.hpp>
@@ -16,7 +17,7 @@ namespace snarkfront {
 //
 
 template <typename ALG>
-void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
+void evalStackOp_Bitwise(EvalStack<ALG>& S, const BitwiseOps op)
 {
     typedef typename ALG::ValueType Value;
     typedef typename ALG::FrType Fr;
@@ -26,7 +27,7 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
     typedef cryptl::BitwiseINT<Value> BitOps;
 
     // y is right argument
-    const auto R = S.top();
+    const auto R = std::move(S.top());
     S.pop();
     const Value yvalue = R.value();
     const Fr ywitness = R.witness();
@@ -34,7 +35,7 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
     // modulo addition
     if (BitwiseOps::ADDMOD == op) {
         // x is left argument
-        const auto L = S.top();
+        const auto L = std::move(S.top());
         S.pop();
         const Value xvalue = L.value();
         const Fr xwitness = L.witness();
@@ -58,7 +59,7 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
 #endif
 
         } else {
-            x_witness = ALG::valueToString(xvalue);
+            x_witness = ALG::valueToField(xvalue);
             const std::vector<R1T> xbits = RS->argBits(L);
             const std::vector<R1T> xfit = rank1_xword(xbits, sizeBits(xvalue));
             x = RS->bitsToWitness(xfit, x_witness);
@@ -87,7 +88,7 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
 #endif
 
         } else {
-            y_witness = ALG::valueToString(yvalue);
+            y_witness = ALG::valueToField(yvalue);
             const std::vector<R1T> ybits = RS->argBits(R);
             const std::vector<R1T> yfit = rank1_xword(ybits, sizeBits(yvalue));
             y = RS->bitsToWitness(yfit, y_witness);
@@ -106,8 +107,17 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
         assert(zvalue == low);
 #endif
 
-        std::vector<int> zbits = valueBits(low);
-        for (std::size_t i = 0; i < xhighCnt + yhighCnt + 1; ++i) {
+        // carry bits for the number of words in the sum, chains of
+        // additions are one linear combination split once
+        const std::size_t
+            wordBits = sizeBits(zvalue),
+            addends = RS->addendCount(x, wordBits, wordBits + xhighCnt)
+                    + RS->addendCount(y, wordBits, wordBits + yhighCnt);
+        std::size_t carryCnt = 0;
+        while ((std::size_t(1) << carryCnt) < addends) ++carryCnt;
+
+        typename ALG::Bits zbits = ALG::splitValue(low);
+        for (std::size_t i = 0; i < carryCnt; ++i) {
             zbits.push_back(high & 0x1);
             high >>= 1;
         }
@@ -117,22 +127,24 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
 
         const Fr zwitness = x_witness + y_witness;
         const R1T z = RS->createResult(op, x, y, zwitness);
+        if (z.index() != x.index() && z.index() != y.index())
+            RS->setAddendCount(z, addends);
 
         S.push(
-            ALG(zvalue, zwitness, zbits, {z}));
+            ALG(zvalue, zwitness, std::move(zbits), {z}));
 
     } else if (BitwiseOps::MULMOD == op) {
         // x is left argument
-        const auto L = S.top();
+        const auto L = std::move(S.top());
         S.pop();
         const Value xvalue = L.value();
-        const Fr x_witness = ALG::valueToString(xvalue);
+        const Fr x_witness = ALG::valueToField(xvalue);
         const std::vector<R1T> xbits = RS->argBits(L);
         const std::vector<R1T> xfit = rank1_xword(xbits, sizeBits(xvalue));
         const R1T x = RS->bitsToWitness(xfit, x_witness);
 
         // right argument
-        const Fr y_witness = ALG::valueToString(yvalue);
+        const Fr y_witness = ALG::valueToField(yvalue);
         const std::vector<R1T> ybits = RS->argBits(R);
         const std::vector<R1T> yfit = rank1_xword(ybits, sizeBits(yvalue));
         const R1T y = RS->bitsToWitness(yfit, y_witness);
@@ -146,7 +158,7 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
         assert(zvalue == low);
 #endif
 
-        std::vector<int> zbits = valueBits(low);
+        typename ALG::Bits zbits = ALG::splitValue(low);
         for (std::size_t i = 0; i < sizeBits(high); ++i) {
             zbits.push_back(high & 0x1);
             high >>= 1;
@@ -159,7 +171,7 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
         const R1T z = RS->createResult(op, x, y, zwitness);
 
         S.push(
-            ALG(zvalue, zwitness, zbits, {z}));
+            ALG(zvalue, zwitness, std::move(zbits), {z}));
 
     } else if (BitwiseOps::CMPLMNT == op) {
         // y is only argument
@@ -172,8 +184,8 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
         // z is result
         const Value zvalue = BitOps::CMPLMNT(yvalue);
 
-        std::vector<int> zbits;
-        std::vector<R1T> z;
+        typename ALG::Bits zbits;
+        typename ALG::Terms z;
         zbits.reserve(sizeBits(zvalue));
         z.reserve(sizeBits(zvalue));
         for (std::size_t i = 0; i < sizeBits(zvalue); ++i) {
@@ -187,11 +199,11 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
 #endif
 
         S.push(
-            ALG(zvalue, ALG::valueToString(zvalue), zbits, z));
+            ALG(zvalue, ALG::valueToField(zvalue), std::move(zbits), std::move(z)));
 
     } else {
         // x is left argument
-        const auto L = S.top();
+        const auto L = std::move(S.top());
         S.pop();
         const Value xvalue = L.value();
         const Fr xwitness = L.witness();
@@ -204,8 +216,7 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
         // z is result
         const Value zvalue = evalOp(op, xvalue, yvalue);
 
-        std::vector<R1T> z;
-        z.reserve(sizeBits(zvalue));
+        typename ALG::Terms z;
 
         if (isPermute(op)) {
             const std::vector<R1T> xfit = rank1_xword(x, sizeBits(xvalue));
@@ -227,38 +238,38 @@ void evalStackOp_Bitwise(std::stack<ALG>& S, const BitwiseOps op)
         }
 
         S.push(
-            ALG(zvalue, ALG::valueToString(zvalue), valueBits(zvalue), z));
+            ALG(zvalue, ALG::valueToField(zvalue), ALG::splitValue(zvalue), std::move(z)));
     }
 }
 
 template <typename FR>
-void evalStackOp(std::stack<Alg_uint8<FR>>& S, const BitwiseOps op) {
+void evalStackOp(EvalStack<Alg_uint8<FR>>& S, const BitwiseOps op) {
     evalStackOp_Bitwise<Alg_uint8<FR>>(S, op);
 }
 
 template <typename FR>
-void evalStackOp(std::stack<Alg_uint32<FR>>& S, const BitwiseOps op) {
+void evalStackOp(EvalStack<Alg_uint32<FR>>& S, const BitwiseOps op) {
     evalStackOp_Bitwise<Alg_uint32<FR>>(S, op);
 }
 
 template <typename FR>
-void evalStackOp(std::stack<Alg_uint64<FR>>& S, const BitwiseOps op) {
+void evalStackOp(EvalStack<Alg_uint64<FR>>& S, const BitwiseOps op) {
     evalStackOp_Bitwise<Alg_uint64<FR>>(S, op);
 }
 
 template <typename FR>
-void evalStackCmp(std::stack<Alg_uint8<FR>>& S, const EqualityCmp op) {
-    evalStackCmp_Equality(S, op);
+void evalStackCmp(EvalStack<Alg_uint8<FR>>& S, const ScalarCmp op) {
+    evalStackCmp_Scalar(S, op);
 }
 
 template <typename FR>
-void evalStackCmp(std::stack<Alg_uint32<FR>>& S, const EqualityCmp op) {
-    evalStackCmp_Equality(S, op);
+void evalStackCmp(EvalStack<Alg_uint32<FR>>& S, const ScalarCmp op) {
+    evalStackCmp_Scalar(S, op);
 }
 
 template <typename FR>
-void evalStackCmp(std::stack<Alg_uint64<FR>>& S, const EqualityCmp op) {
-    evalStackCmp_Equality(S, op);
+void evalStackCmp(EvalStack<Alg_uint64<FR>>& S, const ScalarCmp op) {
+    evalStackCmp_Scalar(S, op);
 }
 
 } // namespace snarkfront
@@ -1,13 +1,23 @@
 #ifndef _SNARKFRONT_BITWISE_AST_HPP_
 #define _SNARKFRONT_BITWISE_AST_HPP_
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <climits>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 #include <snarkfront/Alg.hpp>
 #include <snarkfront/AST.hpp>
+#include <snarkfront/EnumOps.hpp>
+#include <snarkfront/EvalAST.hpp>
+#include <snarkfront/PowersOf2.hpp>
+#include <snarkfront/Profiler.hpp>
+#include <snarkfront/R1C.hpp>
+#include <snarkfront/Rank1Ops.hpp>
+#include <snarkfront/TLsingleton.hpp>
 
 namespace snarkfront {
 
@@ -26,6 +36,7 @@ class BitwiseAST
 
     typedef typename T::ValueType VAL;
     typedef typename T::FrType FR;
+    typedef typename T::R1T R1T;
 
 public:
     // bitwise complement
@@ -58,6 +69,24 @@ public:
 
 #undef DEFN_OPXY
 
+#define DEFN_OPXYZ(NAME)                                                \
+    template <typename X, typename Y, typename Z>                       \
+    static AST_X<T> NAME (const X& x, const Y& y, const Z& z) {         \
+        return AST_X<T>(ternaryOp(T::OpType:: NAME , x, y, z));         \
+    }                                                                   \
+    template <typename X, typename Y, typename Z>                       \
+    static AST_X<T>* _ ## NAME (const X& x, const Y& y, const Z& z) {   \
+        return new AST_X<T>(ternaryOp(T::OpType:: NAME , x, y, z));     \
+    }
+
+    // CH (choose), MAJ (majority), XOR3 (three-way XOR) as in SHA-1/2,
+    // evaluated now with one or two constraints for each bit
+    DEFN_OPXYZ(CH)
+    DEFN_OPXYZ(MAJ)
+    DEFN_OPXYZ(XOR3)
+
+#undef DEFN_OPXYZ
+
 #define DEFN_SHIFT(NAME)                                                \
     template <typename X>                                               \
     static AST_Op<T> NAME (const X& x, const unsigned int n) {          \
@@ -220,21 +249,16 @@ public:
         return new AST_X<T>(b);
     }
 
-    // ternary
+    // ternary, y + b * (x - y) if either argument is a scalar,
+    // otherwise CH(b, x, y) for each bit
     template <typename B, typename X, typename Y>
-    static AST_Op<T> ternary(const B& b, const X& x, const Y& y) {
-        // (x & xword(b)) | (y & ~xword(b))
-        return OR(
-            _AND(x, _bitmask(b)),
-            _AND(y, _CMPLMNT(_bitmask(b))));
+    static AST_X<T> ternary(const B& b, const X& x, const Y& y) {
+        return AST_X<T>(selectOp(b, x, y));
     }
 
     template <typename B, typename X, typename Y>
-    static AST_Op<T>* _ternary(const B& b, const X& x, const Y& y) {
-        // (x & xword(b)) | (y & ~xword(b))
-        return _OR(
-            _AND(x, _bitmask(b)),
-            _AND(y, _CMPLMNT(_bitmask(b))));
+    static AST_X<T>* _ternary(const B& b, const X& x, const Y& y) {
+        return new AST_X<T>(selectOp(b, x, y));
     }
 
     // test bit
@@ -254,94 +278,29 @@ public:
         return new AST_X<Alg_bool<FR>>(SHR(x, n));
     }
 
-    // look-up table
+    // look-up table, one-hot selectors from the index bits and each
+    // result bit is the sum of selectors for entries with the bit set
+    // (index of N or more returns all clear bits)
     template <typename X, std::size_t N>
-    static AST_Op<T> lookuptable(const std::array<VAL, N>& a, const X& idx) {
-        if (1 == N) {
-            // returns value if index is 0, else all clear bits
-            return AND(
-                _constant(a[0]),
-                _CMPLMNT(_bitmask(0 != idx)));
-
-        } else {
-            auto sum = _AND(
-                _constant(a[0]),
-                _CMPLMNT(_bitmask(0 != idx)));
-
-            for (std::size_t i = 1; i < N - 1; ++i) {
-                sum = _ADDMOD(
-                    sum,
-                    _AND(_constant(a[i]),
-                         _CMPLMNT(_bitmask(i != idx))));
-            }
-
-            return ADDMOD(
-                sum,
-                _AND(_constant(a[N-1]),
-                     _CMPLMNT(_bitmask((N-1) != idx))));
-        }
+    static AST_X<T> lookuptable(const std::array<VAL, N>& a, const X& idx) {
+        return AST_X<T>(lookupEval(a, evalNode(idx)));
     }
 
     template <typename X, std::size_t N>
-    static AST_Op<T>* _lookuptable(const std::array<VAL, N>& a, const X& idx) {
-        if (1 == N) {
-            // returns value if index is 0, else all clear bits
-            return _AND(
-                _constant(a[0]),
-                _CMPLMNT(_bitmask(0 != idx)));
-
-        } else {
-            auto sum = _AND(
-                _constant(a[0]),
-                _CMPLMNT(_bitmask(0 != idx)));
-
-            for (std::size_t i = 1; i < N - 1; ++i) {
-                sum = _ADDMOD(
-                    sum,
-                    _AND(_constant(a[i]),
-                         _CMPLMNT(_bitmask(i != idx))));
-            }
-
-            return _ADDMOD(
-                sum,
-                _AND(_constant(a[N-1]),
-                     _CMPLMNT(_bitmask((N-1) != idx))));
-        }
+    static AST_X<T>* _lookuptable(const std::array<VAL, N>& a, const X& idx) {
+        return new AST_X<T>(lookupEval(a, evalNode(idx)));
     }
 
-    // array subscript
+    // array subscript, sum of entries times one-hot selectors
+    // (index of N or more returns all clear bits)
     template <typename X, typename Y, std::size_t N>
-    static AST_Op<T> arraysubscript(const std::array<Y, N>& a, const X& idx) {
-        if (1 == N) {
-            // returns value if index is 0, else all clear bits
-            return AND(a[0], _CMPLMNT(_bitmask(0 != idx)));
-
-        } else {
-            auto sum = _AND(a[0], _CMPLMNT(_bitmask(0 != idx)));
-
-            for (std::size_t i = 1; i < N - 1; ++i) {
-                sum = _ADDMOD(sum, _AND(a[i], _CMPLMNT(_bitmask(i != idx))));
-            }
-
-            return ADDMOD(sum, _AND(a[N-1], _CMPLMNT(_bitmask((N-1) != idx))));
-        }
+    static AST_X<T> arraysubscript(const std::array<Y, N>& a, const X& idx) {
+        return AST_X<T>(subscriptEval(a, evalNode(idx)));
     }
 
     template <typename X, typename Y, std::size_t N>
-    static AST_Op<T>* _arraysubscript(const std::array<Y, N>& a, const X& idx) {
-        if (1 == N) {
-            // returns value if index is 0, else all clear bits
-            return _AND(a[0], _CMPLMNT(_bitmask(0 != idx)));
-
-        } else {
-            auto sum = _AND(a[0], _CMPLMNT(_bitmask(0 != idx)));
-
-            for (std::size_t i = 1; i < N - 1; ++i) {
-                sum = _ADDMOD(sum, _AND(a[i], _CMPLMNT(_bitmask(i != idx))));
-            }
-
-            return _ADDMOD(sum, _AND(a[N-1], _CMPLMNT(_bitmask((N-1) != idx))));
-        }
+    static AST_X<T>* _arraysubscript(const std::array<Y, N>& a, const X& idx) {
+        return new AST_X<T>(subscriptEval(a, evalNode(idx)));
     }
 
     // multiplication by x in GF(2^n)
@@ -373,6 +332,189 @@ public:
     }
 
 private:
+    // nodes evaluated now, heap nodes are owned here like operator links
+    template <typename A = T, typename X>
+    static A evalNode(const X& x) {
+        EvalAST<A> E;
+        x.accept(E);
+        return E.takeResult();
+    }
+
+    template <typename A = T, typename X>
+    static A evalNode(X* x) {
+        A a = evalNode<A>(*x);
+        delete x;
+        return a;
+    }
+
+    template <typename B, typename X, typename Y>
+    static T selectOp(const B& b, const X& x, const Y& y) {
+        const Alg_bool<FR> c = evalNode<Alg_bool<FR>>(b);
+        const T u = evalNode(x);
+        const T v = evalNode(y);
+        return selectEval(c, u, v);
+    }
+
+    static T selectEval(const Alg_bool<FR>& b, const T& x, const T& y) {
+        auto& RS = TL<R1C<FR>>::singleton();
+
+        const bool bvalue = b.value();
+        const R1T c = RS->argScalar(b);
+
+        // constant condition
+        if (! c.isVariable()) return bvalue ? x : y;
+
+        if (1 != x.r1Terms().size() && 1 != y.r1Terms().size()) {
+            // both arguments are bits
+            const VAL value = bvalue ? x.value() : y.value();
+            const auto xbits = RS->argBits(x);
+            const auto ybits = RS->argBits(y);
+
+            typename T::Terms terms;
+            for (std::size_t i = 0; i < sizeBits(value); ++i) {
+                terms.push_back(
+                    RS->createResult(BitwiseOps::CH,
+                                     { c, xbits[i], ybits[i] },
+                                     { bvalue, x.splitBits()[i], y.splitBits()[i] }));
+            }
+
+            return T(value, T::valueToField(value), T::splitValue(value), std::move(terms));
+        }
+
+        // z = y + b * (x - y), one constraint for the word, overflow
+        // from modulo addition is kept and split later if needed
+        const R1T
+            xs = RS->argScalar(x),
+            ys = RS->argScalar(y);
+
+        const FR
+            xw = x.witness(),
+            yw = y.witness(),
+            zw = bvalue ? xw : yw;
+
+        const R1T d = RS->sumTerms({ xs, ys }, { FR::one(), FR::zero() - FR::one() },
+                                   xw - yw, false);
+        const R1T p = RS->createResult(ScalarOps::MUL, c, d, bvalue ? xw - yw : FR::zero());
+        const R1T z = RS->sumTerms({ ys, p }, { FR::one(), FR::one() }, zw, false);
+
+        const std::size_t
+            xcarry = x.splitBits().size() - sizeBits(x.value()),
+            ycarry = y.splitBits().size() - sizeBits(y.value());
+
+        RS->setAddendCount(
+            z,
+            std::max(RS->addendCount(xs, sizeBits(x.value()), x.splitBits().size()),
+                     RS->addendCount(ys, sizeBits(y.value()), y.splitBits().size())));
+
+        typename T::Bits zbits = bvalue ? x.splitBits() : y.splitBits();
+        while (zbits.size() < sizeBits(x.value()) + std::max(xcarry, ycarry))
+            zbits.push_back(0);
+
+        return T(bvalue ? x.value() : y.value(), zw, std::move(zbits), { z });
+    }
+
+    // arguments in order (each may make variables)
+    template <typename X, typename Y, typename Z>
+    static T ternaryOp(const typename T::OpType op, const X& x, const Y& y, const Z& z) {
+        const T a = evalNode(x);
+        const T b = evalNode(y);
+        const T c = evalNode(z);
+        return ternaryEval(op, a, b, c);
+    }
+
+    static T ternaryEval(const typename T::OpType op, const T& x, const T& y, const T& z) {
+        auto& RS = TL<R1C<FR>>::singleton();
+        const ProfileOp prof(RS->profiler(), opName(op));
+
+        const VAL value = evalOp(op, x.value(), y.value(), z.value());
+
+        // low bits only if argument has overflow from modulo addition
+        const auto xbits = RS->argBits(x);
+        const auto ybits = RS->argBits(y);
+        const auto zbits = RS->argBits(z);
+
+        typename T::Terms terms;
+        for (std::size_t i = 0; i < sizeBits(value); ++i) {
+            terms.push_back(
+                RS->createResult(op,
+                                 { xbits[i], ybits[i], zbits[i] },
+                                 { x.splitBits()[i], y.splitBits()[i], z.splitBits()[i] }));
+        }
+
+        return T(value, T::valueToField(value), T::splitValue(value), std::move(terms));
+    }
+
+    // selectors for entries 0 to N-1, fewer if the index bits can not
+    // reach them all (entries after that are never selected)
+    static std::vector<typename T::R1T> selectors(const T& idx, const std::size_t N) {
+        auto& RS = TL<R1C<FR>>::singleton();
+
+        // low bits only if index has overflow from modulo addition
+        auto b = RS->argBits(idx);
+        b.resize(sizeBits(idx.value()));
+
+        return RS->oneHot(b, idx.value(), N);
+    }
+
+    template <std::size_t N>
+    static T lookupEval(const std::array<VAL, N>& a, const T& idx) {
+        auto& RS = TL<R1C<FR>>::singleton();
+
+        const std::size_t i = idx.value();
+        const VAL value = (i < N) ? a[i] : 0;
+        const auto s = selectors(idx, N);
+
+        // one constraint for each result bit, used many times after
+        typename T::Terms terms;
+        for (std::size_t m = 0; m < sizeBits(value); ++m) {
+            std::vector<typename T::R1T> x;
+            for (std::size_t j = 0; j < s.size(); ++j) {
+                if ((a[j] >> m) & 0x1) x.push_back(s[j]);
+            }
+
+            terms.push_back(
+                RS->sumTerms(x,
+                             std::vector<FR>(x.size(), FR::one()),
+                             boolTo<FR>((value >> m) & 0x1),
+                             true));
+        }
+
+        return T(value, T::valueToField(value), T::splitValue(value), std::move(terms));
+    }
+
+    template <typename Y, std::size_t N>
+    static T subscriptEval(const std::array<Y, N>& a, const T& idx) {
+        auto& RS = TL<R1C<FR>>::singleton();
+
+        const std::size_t i = idx.value();
+        VAL value = 0;
+        const auto s = selectors(idx, N);
+
+        // product of each entry (as scalar) and its selector
+        std::vector<typename T::R1T> p;
+        for (std::size_t j = 0; j < s.size(); ++j) {
+            const T x = evalNode(a[j]);
+            const VAL xvalue = x.value();
+            const FR x_witness = T::valueToField(xvalue);
+            const auto xbits = RS->argBits(x);
+            const auto xfit = rank1_xword(xbits, sizeBits(xvalue));
+            const auto y = RS->bitsToWitness(xfit, x_witness);
+
+            if (j == i) value = xvalue;
+
+            p.push_back(
+                RS->createResult(ScalarOps::MUL, s[j], y,
+                                 (j == i) ? x_witness : FR::zero()));
+        }
+
+        const FR witness = T::valueToField(value);
+
+        return T(value,
+                 witness,
+                 T::splitValue(value),
+                 { RS->sumTerms(p, std::vector<FR>(p.size(), FR::one()), witness, false) });
+    }
+
     template <typename X, typename Y, typename M>
     static AST_Op<T>* multiply_internal(const X& a, const Y& b, const M& modpoly) {
         constexpr std::size_t N = sizeof(VAL) * CHAR_BIT;
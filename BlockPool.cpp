@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#include "snarkfront/BlockPool.hpp"
+
+using namespace std;
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// small block allocator for AST nodes
+//
+
+namespace {
+
+// chunks and free lists left by threads that have exited
+struct Reserve
+{
+    Reserve() {
+        freeLists.fill(nullptr);
+    }
+
+    ~Reserve() {
+        for (const auto& p : chunks)
+            ::operator delete(p);
+
+        for (const auto& p : spare)
+            ::operator delete(p);
+    }
+
+    mutex lock;
+    vector<char*> chunks; // some blocks still in use
+    vector<char*> spare;  // no blocks in use, at most SPARE
+    array<void*, BlockPool::CLASSES> freeLists;
+};
+
+Reserve& reserve() {
+    static Reserve obj;
+    return obj;
+}
+
+// free list link is the first word of a block
+void*& nextBlock(void* p) {
+    return *static_cast<void**>(p);
+}
+
+} // namespace
+
+BlockPool::BlockPool()
+    : m_next(nullptr),
+      m_end(nullptr)
+{
+    m_freeList.fill(nullptr);
+}
+
+BlockPool::~BlockPool() {
+    // chunk containing a block, or none if from another pool
+    vector<pair<uintptr_t, size_t>> sorted;
+    for (size_t i = 0; i < m_chunks.size(); ++i)
+        sorted.emplace_back(reinterpret_cast<uintptr_t>(m_chunks[i]), i);
+
+    sort(sorted.begin(), sorted.end());
+
+    const size_t NONE = m_chunks.size();
+    const auto owner = [&sorted, NONE] (void* p) -> size_t {
+        const uintptr_t a = reinterpret_cast<uintptr_t>(p);
+        auto it = upper_bound(sorted.begin(), sorted.end(), make_pair(a, NONE));
+        if (sorted.begin() == it) return NONE;
+        --it;
+        return (a - it->first < CHUNK) ? it->second : NONE;
+    };
+
+    // chunks are released if every block carved from them is free
+    vector<size_t> freeBytes(m_chunks.size(), 0);
+    for (size_t k = 0; k < CLASSES; ++k) {
+        for (void* p = m_freeList[k]; p; p = nextBlock(p)) {
+            const size_t i = owner(p);
+            if (NONE != i) freeBytes[i] += (k + 1) * ALIGN;
+        }
+    }
+
+    vector<bool> release(m_chunks.size());
+    for (size_t i = 0; i < m_chunks.size(); ++i)
+        release[i] = (freeBytes[i] == m_carved[i]);
+
+    auto& R = reserve();
+    lock_guard<mutex> guard(R.lock);
+
+    // remaining free blocks are added to the reserve lists
+    for (size_t k = 0; k < CLASSES; ++k) {
+        void *head = R.freeLists[k], *p = m_freeList[k];
+        while (p) {
+            void* next = nextBlock(p);
+            const size_t i = owner(p);
+            if (NONE == i || ! release[i]) {
+                nextBlock(p) = head;
+                head = p;
+            }
+
+            p = next;
+        }
+
+        R.freeLists[k] = head;
+    }
+
+    for (size_t i = 0; i < m_chunks.size(); ++i) {
+        if (! release[i])
+            R.chunks.push_back(m_chunks[i]);
+        else if (R.spare.size() < SPARE)
+            R.spare.push_back(m_chunks[i]);
+        else
+            ::operator delete(m_chunks[i]);
+    }
+}
+
+void* BlockPool::allocate(const size_t n) {
+    const size_t k = sizeClass(n);
+    if (k >= CLASSES) return ::operator new(n);
+
+    void* p = m_freeList[k];
+    if (! p) p = carve(k);
+
+    m_freeList[k] = nextBlock(p);
+    return p;
+}
+
+void BlockPool::deallocate(void* p, const size_t n) {
+    const size_t k = sizeClass(n);
+    if (k >= CLASSES) {
+        ::operator delete(p);
+
+    } else {
+        nextBlock(p) = m_freeList[k];
+        m_freeList[k] = p;
+    }
+}
+
+// free list for size class is empty, returns a new one
+void* BlockPool::carve(const size_t k) {
+    const size_t len = (k + 1) * ALIGN;
+    char* chunk = nullptr;
+
+    auto& R = reserve();
+    {
+        lock_guard<mutex> guard(R.lock);
+
+        // blocks freed by exited threads, the whole list
+        if (R.freeLists[k]) {
+            void* p = R.freeLists[k];
+            R.freeLists[k] = nullptr;
+            return p;
+        }
+
+        // chunk released by an exited thread
+        if (static_cast<size_t>(m_end - m_next) < len && ! R.spare.empty()) {
+            chunk = R.spare.back();
+            R.spare.pop_back();
+        }
+    }
+
+    if (static_cast<size_t>(m_end - m_next) < len) {
+        if (! chunk) chunk = static_cast<char*>(::operator new(CHUNK));
+        m_next = chunk;
+        m_end = m_next + CHUNK;
+        m_chunks.push_back(m_next);
+        m_carved.push_back(0);
+    }
+
+    void* p = m_next;
+    m_next += len;
+    m_carved.back() += len;
+    nextBlock(p) = nullptr;
+    return p;
+}
+
+} // namespace snarkfront
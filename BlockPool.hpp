@@ -0,0 +1,56 @@
+#ifndef _SNARKFRONT_BLOCK_POOL_HPP_
+#define _SNARKFRONT_BLOCK_POOL_HPP_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// small block allocator for AST nodes
+//
+// Blocks are carved from large chunks and kept on free lists by size
+// class, so allocating and releasing a node is a pointer swap instead
+// of a heap call. Each thread has its own pool (no locking). When a
+// thread exits, chunks with every block free go to a shared reserve of
+// at most SPARE chunks (the rest are deleted). Chunks with blocks still
+// in use, and free blocks from other chunks, go to the reserve too, so
+// nodes may outlive the thread that made them. New pools draw on the
+// reserve before allocating chunks. Blocks larger than the biggest size
+// class come from the heap.
+//
+
+class BlockPool
+{
+public:
+    BlockPool();
+    ~BlockPool();
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator= (const BlockPool&) = delete;
+
+    void* allocate(const std::size_t n);
+
+    // n must be the same size as allocated
+    void deallocate(void* p, const std::size_t n);
+
+    static const std::size_t
+        ALIGN = 16, CLASSES = 32, CHUNK = 64 * 1024, SPARE = 64;
+
+private:
+    static std::size_t sizeClass(const std::size_t n) {
+        return (0 == n ? 0 : (n - 1) / ALIGN);
+    }
+
+    void* carve(const std::size_t k);
+
+    std::array<void*, CLASSES> m_freeList;
+    std::vector<char*> m_chunks;
+    std::vector<std::size_t> m_carved; // bytes of each chunk in blocks
+    char *m_next, *m_end;
+};
+
+} // namespace snarkfront
+
+#endif
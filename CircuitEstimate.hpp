@@ -0,0 +1,213 @@
+#ifndef _SNARKFRONT_CIRCUIT_ESTIMATE_HPP_
+#define _SNARKFRONT_CIRCUIT_ESTIMATE_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include <snarklib/QAP_query.hpp>
+#include <snarklib/WindowExp.hpp>
+
+#include <snarkfront/R1C.hpp>
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// key pair size and cost from a count only run
+//
+// Exponentiation counts are the same as qap computes from the query
+// files. Disk, memory and time are estimates for key generation with
+// the G1 exponentiation table in numWindowBlocks (-e) and the query
+// vectors in numBlocks (-n). Time is from group and field operation
+// counts with each operation timed on this machine.
+//
+
+template <typename PAIRING>
+class CircuitEstimate
+{
+    typedef typename PAIRING::Fr FR;
+    typedef typename PAIRING::G1 G1;
+    typedef typename PAIRING::G2 G2;
+
+public:
+    CircuitEstimate(const R1Count& counts,
+                    const std::size_t numWindowBlocks,
+                    const std::size_t numBlocks)
+        : m_counts(counts),
+          m_numWindowBlocks(std::max(numWindowBlocks, std::size_t(1))),
+          m_numBlocks(std::max(numBlocks, std::size_t(1))),
+          m_degree(qapDegree(counts.constraints + counts.inputs + 1)),
+          m_g1_exp_count(snarklib::g1_exp_count(
+                             counts.variables,
+                             counts.inputs,
+                             counts.nonzeroA,
+                             counts.nonzeroB,
+                             counts.nonzeroC,
+                             m_degree + 1)),
+          m_g2_exp_count(snarklib::g2_exp_count(
+                             counts.nonzeroB))
+    {}
+
+    const R1Count& counts() const { return m_counts; }
+
+    std::size_t qap_degree() const { return m_degree; }
+    std::size_t g1_exp_count() const { return m_g1_exp_count; }
+    std::size_t g2_exp_count() const { return m_g2_exp_count; }
+
+    // constraint system, QAP query and key pair files
+    std::uint64_t diskBytes() const {
+        const std::uint64_t
+            V = m_counts.variables,
+            N = m_counts.inputs,
+            H = m_degree + 1,
+            IDX = sizeof(std::size_t);
+
+        const std::uint64_t
+            sysBytes = m_counts.terms * (sizeof(FR) + IDX),
+            qapBytes = (3 * (V + 1) + H + (V + 4) + (N + 1)) * sizeof(FR),
+            pkBytes = m_counts.nonzeroA * (2 * sizeof(G1) + IDX)
+                    + m_counts.nonzeroB * (sizeof(G2) + sizeof(G1) + IDX)
+                    + m_counts.nonzeroC * (2 * sizeof(G1) + IDX)
+                    + H * sizeof(G1)
+                    + (V + 4) * sizeof(G1),
+            vkBytes = (N + 1) * sizeof(G1) + 8 * sizeof(G2);
+
+        return sysBytes + qapBytes + pkBytes + vkBytes;
+    }
+
+    // peak of QAP query (whole vector) and PPZK query (one block with
+    // one window block of exponentiation table) generation
+    std::uint64_t memoryBytes() const {
+        const std::uint64_t
+            V = m_counts.variables,
+            H = m_degree + 1;
+
+        // Lagrange coefficients and query vector
+        const std::uint64_t qapBytes = (H + std::max(V + 1, H)) * sizeof(FR);
+
+        // largest proving key query
+        const std::uint64_t queryBytes = std::max({
+                m_counts.nonzeroA * 2 * sizeof(G1),
+                m_counts.nonzeroB * (sizeof(G2) + sizeof(G1)),
+                m_counts.nonzeroC * 2 * sizeof(G1),
+                H * sizeof(G1),
+                (V + 4) * sizeof(G1) });
+
+        const std::uint64_t ppzkBytes =
+            (queryBytes + m_numBlocks - 1) / m_numBlocks
+            + tableSize<G1>(m_g1_exp_count) * sizeof(G1) / m_numWindowBlocks
+            + tableSize<G2>(m_g2_exp_count) * sizeof(G2);
+
+        return std::max(qapBytes, ppzkBytes);
+    }
+
+    // key generation time, runs a short benchmark
+    double seconds() const {
+        // tables A, B, C, H, K made again for each query block, IC once
+        const double
+            g1_adds = double(m_g1_exp_count) * windowCount<G1>(m_g1_exp_count)
+                    + double(tableSize<G1>(m_g1_exp_count)) * (5 * m_numBlocks + 1),
+            g2_adds = double(m_g2_exp_count) * windowCount<G2>(m_g2_exp_count)
+                    + double(tableSize<G2>(m_g2_exp_count)) * m_numBlocks,
+            fr_muls = 3.0 * (m_degree + 1) + m_counts.terms;
+
+        return g1_adds * timeAdd<G1>()
+            + g2_adds * timeAdd<G2>()
+            + fr_muls * timeMul();
+    }
+
+    void writeText(std::ostream& os) const {
+        os << "constraints " << m_counts.constraints << std::endl
+           << "variables " << m_counts.variables << std::endl
+           << "inputs " << m_counts.inputs << std::endl
+           << "nonzero A " << m_counts.nonzeroA
+           << " B " << m_counts.nonzeroB
+           << " C " << m_counts.nonzeroC << std::endl
+           << "QAP degree " << m_degree << std::endl
+           << "g1_exp_count " << m_g1_exp_count << std::endl
+           << "g2_exp_count " << m_g2_exp_count << std::endl
+           << "partitions -e " << m_numWindowBlocks
+           << " -n " << m_numBlocks << std::endl
+           << "disk bytes " << diskBytes() << std::endl
+           << "memory bytes " << memoryBytes() << std::endl
+           << "key generation seconds " << seconds() << std::endl;
+    }
+
+private:
+    // evaluation domain size, power of two or sum of two powers of two
+    // (same rounding as radix-2 and step radix-2 domains)
+    static std::size_t qapDegree(const std::size_t minSize) {
+        std::size_t big = 1;
+        while (2 * big <= minSize) big *= 2;
+        if (big == minSize) return big;
+
+        std::size_t small = 1;
+        while (small < minSize - big) small *= 2;
+        return big + small;
+    }
+
+    template <typename T>
+    static std::size_t windowCount(const std::size_t expCount) {
+        return snarklib::WindowExp<T>::space(expCount).globalID()[0];
+    }
+
+    // each window covers its share of the scalar bits
+    template <typename T>
+    static std::uint64_t tableSize(const std::size_t expCount) {
+        const std::size_t
+            N = windowCount<T>(expCount),
+            bits = (8 * sizeof(FR) + N - 1) / N;
+
+        return std::uint64_t(N) << std::min(bits, std::size_t(63));
+    }
+
+    static const std::size_t BENCHMARK = 1 << 12;
+
+    template <typename T>
+    static double timeAdd() {
+        const auto start = std::chrono::steady_clock::now();
+        T a = T::one(), b = T::one();
+        for (std::size_t i = 0; i < BENCHMARK; ++i) {
+            a = a + b;
+            b = b + a;
+        }
+
+        // use the result
+        return perOp(start, 2 * BENCHMARK + (a == b));
+    }
+
+    static double timeMul() {
+        const auto start = std::chrono::steady_clock::now();
+        FR a = FR::one() + FR::one(), b = a;
+        for (std::size_t i = 0; i < BENCHMARK; ++i) {
+            a = a * b;
+            b = b * a;
+        }
+
+        return perOp(start, 2 * BENCHMARK + (a == b));
+    }
+
+    static double perOp(const std::chrono::steady_clock::time_point& start,
+                        const std::size_t count)
+    {
+        const double elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        return elapsed / count;
+    }
+
+    const R1Count m_counts;
+    const std::size_t m_numWindowBlocks, m_numBlocks;
+    const std::size_t m_degree, m_g1_exp_count, m_g2_exp_count;
+};
+
+template <typename PAIRING>
+std::ostream& operator<< (std::ostream& os, const CircuitEstimate<PAIRING>& a) {
+    a.writeText(os);
+    return os;
+}
+
+} // namespace snarkfront
+
+#endif
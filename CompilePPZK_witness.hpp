@@ -14,6 +14,8 @@
 #include <snarklib/Rank1DSL.hpp>
 #include <snarklib/Util.hpp>
 
+#include <snarkfront/WitnessFile.hpp>
+
 namespace snarkfront {
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -34,9 +36,9 @@ public:
           m_reserveTune(0),
           m_hugeSystem(sysfile)
     {
-        std::ifstream ifsR(randfile), ifsW(witfile);
+        std::ifstream ifsR(randfile);
         if (!ifsR || !m_randomness.marshal_in(ifsR) ||
-            !ifsW || !m_witness.marshal_in(ifsW) ||
+            !marshal_in_witness(m_witness, witfile) ||
             !m_hugeSystem.loadIndex())
         {
             m_error = true;
@@ -60,8 +62,7 @@ public:
           m_hugeSystem(sysfile),
           m_randomness(proofRand)
     {
-        std::ifstream ifs(witfile);
-        if (!ifs || !m_witness.marshal_in(ifs) || !m_hugeSystem.loadIndex())
+        if (!marshal_in_witness(m_witness, witfile) || !m_hugeSystem.loadIndex())
         {
             m_error = true;
         }
@@ -211,9 +212,9 @@ public:
         : m_error(false),
           m_reserveTune(0)
     {
-        std::ifstream ifsR(randfile), ifsW(witfile);
+        std::ifstream ifsR(randfile);
         if (!ifsR || !m_randomness.marshal_in(ifsR) ||
-            !ifsW || !m_witness.marshal_in(ifsW)) {
+            !marshal_in_witness(m_witness, witfile)) {
             m_error = true;
 
         } else {
@@ -230,8 +231,7 @@ public:
           m_reserveTune(0),
           m_randomness(proofRand)
     {
-        std::ifstream ifs(witfile);
-        if (!ifs || !m_witness.marshal_in(ifs)) {
+        if (!marshal_in_witness(m_witness, witfile)) {
             m_error = true;
 
         } else {
@@ -17,6 +17,8 @@
 #include <snarklib/Rank1DSL.hpp>
 #include <snarklib/Util.hpp>
 
+#include <snarkfront/WitnessFile.hpp>
+
 namespace snarkfront {
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -386,10 +388,10 @@ public:
         : m_numBlocks(numBlocks),
           m_hugeSystem(sysfile)
     {
-        std::ifstream ifsR(randfile), ifsW(witfile);
+        std::ifstream ifsR(randfile);
         m_error =
             !ifsR || !m_randomness.marshal_in(ifsR) ||
-            !ifsW || !m_witness.marshal_in(ifsW) ||
+            !marshal_in_witness(m_witness, witfile) ||
             !m_hugeSystem.loadIndex();
     }
 
@@ -401,9 +403,8 @@ public:
           m_hugeSystem(sysfile),
           m_randomness(proofRand)
     {
-        std::ifstream ifs(witfile);
         m_error =
-            !ifs || !m_witness.marshal_in(ifs) ||
+            !marshal_in_witness(m_witness, witfile) ||
             !m_hugeSystem.loadIndex();
     }
 
@@ -0,0 +1,299 @@
+#ifndef _SNARKFRONT_COMPILE_R1CS_HPP_
+#define _SNARKFRONT_COMPILE_R1CS_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <snarklib/HugeSystem.hpp>
+#include <snarklib/Rank1DSL.hpp>
+
+#include <snarkfront/Rank1Ops.hpp>
+#include <snarkfront/WitnessFile.hpp>
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// constraint system optimization
+//
+// Streams the constraint system files one block at a time:
+// - variables pinned by x == constant are substituted
+// - constraints satisfied by constants alone are dropped
+// - repeated booleanity constraints on the same variable are dropped
+// - unused variables are removed and the rest renumbered in order
+//
+// Public circuit inputs are never pinned or renumbered, so the input
+// file is unchanged. The witness must be rewritten to match.
+//
+
+template <typename PAIRING>
+class R1CS_optimizer
+{
+    typedef typename PAIRING::Fr FR;
+    typedef snarklib::R1Term<FR> R1T;
+    typedef snarklib::R1Variable<FR> R1V;
+    typedef snarklib::R1Combination<FR> R1LC;
+    typedef snarklib::R1Constraint<FR> R1CON;
+
+public:
+    R1CS_optimizer(const std::string& sysfile)
+        : m_error(false),
+          m_hugeSystem(sysfile),
+          m_numInputs(0),
+          m_numVariables(0),
+          m_keepCount(0),
+          m_trivialCount(0),
+          m_booleanCount(0)
+    {
+        if (! m_hugeSystem.loadIndex()) {
+            m_error = true;
+        } else {
+            m_numInputs = m_hugeSystem.numCircuitInputs();
+            m_numVariables = m_hugeSystem.maxIndex();
+            findPinned();
+            findUsed();
+        }
+    }
+
+    bool operator! () const { return m_error; }
+
+    // optimized constraint system
+    void writeFiles(const std::string& outfile, const std::size_t maxSize) {
+        if (m_error) return;
+
+        snarklib::HugeSystem<FR> S;
+        S.clearAppend(outfile, maxSize);
+
+        std::vector<bool> booleanity(m_numVariables + 1, false);
+        const auto func = [this] (const std::size_t i) { return m_newIndex[i]; };
+
+        m_error = ! m_hugeSystem.mapLambda(
+            [this, &S, &booleanity, &func] (const snarklib::R1System<FR>& a) {
+                R1CON b;
+                for (const auto& c : a.constraints()) {
+                    if (KEEP == rewrite(c, booleanity, b))
+                        S.addConstraint(rank1_remap(b, func));
+                }
+            });
+
+        S.finalize(m_numInputs);
+        if (! S) m_error = true;
+    }
+
+    // witness for optimized constraint system
+    void writeWitness(const std::string& infile, const std::string& outfile) {
+        if (m_error) return;
+
+        snarklib::R1Witness<FR> a, b;
+        if (! marshal_in_witness(a, infile) || a.size() < m_numVariables) {
+            m_error = true;
+            return;
+        }
+
+        for (std::size_t i = 1; i <= m_numVariables; ++i) {
+            if (m_newIndex[i])
+                b.assignVar(R1V(m_newIndex[i]), a[i]);
+        }
+
+        std::ofstream ofs(outfile);
+        if (!ofs)
+            m_error = true;
+        else
+            marshal_out_witness(ofs, b);
+    }
+
+    std::size_t numConstraints() const { return m_keepCount; }
+    std::size_t numVariables() const { return m_newCount; }
+    std::size_t pinnedVariables() const { return m_pinned.size(); }
+    std::size_t trivialConstraints() const { return m_trivialCount; }
+    std::size_t booleanityConstraints() const { return m_booleanCount; }
+
+private:
+    enum Rewrite { KEEP, TRIVIAL, BOOLEANITY };
+
+    // first pass: variables pinned to constant values
+    void findPinned() {
+        m_error = ! m_hugeSystem.mapLambda(
+            [this] (const snarklib::R1System<FR>& a) {
+                for (const auto& c : a.constraints()) {
+                    std::size_t x;
+                    FR value;
+                    if (isPinned(c, x, value) && x > m_numInputs && ! m_pinned.count(x))
+                        m_pinned.emplace(x, value);
+                }
+            });
+    }
+
+    // second pass: variables in constraints after rewriting
+    void findUsed() {
+        if (m_error) return;
+
+        std::vector<bool> used(m_numVariables + 1, false), booleanity(used);
+
+        m_error = ! m_hugeSystem.mapLambda(
+            [this, &used, &booleanity] (const snarklib::R1System<FR>& a) {
+                R1CON b;
+                for (const auto& c : a.constraints()) {
+                    switch (rewrite(c, booleanity, b)) {
+                    case (KEEP) :
+                        ++m_keepCount;
+                        markUsed(b.a(), used);
+                        markUsed(b.b(), used);
+                        markUsed(b.c(), used);
+                        break;
+
+                    case (TRIVIAL) : ++m_trivialCount; break;
+                    case (BOOLEANITY) : ++m_booleanCount; break;
+                    }
+                }
+            });
+
+        // public inputs keep their indices
+        m_newIndex.assign(m_numVariables + 1, 0);
+        m_newCount = 0;
+        for (std::size_t i = 1; i <= m_numVariables; ++i) {
+            if (i <= m_numInputs || used[i])
+                m_newIndex[i] = ++m_newCount;
+        }
+    }
+
+    void markUsed(const R1LC& a, std::vector<bool>& used) const {
+        for (const auto& t : a.terms()) {
+            if (t.isVariable()) used[t.index()] = true;
+        }
+    }
+
+    Rewrite rewrite(const R1CON& c,
+                    std::vector<bool>& booleanity,
+                    R1CON& out) const
+    {
+        std::size_t x;
+        if (isBooleanity(c, x) && ! m_pinned.count(x)) {
+            if (booleanity[x]) return BOOLEANITY;
+            booleanity[x] = true;
+        }
+
+        const R1LC
+            A = substitute(c.a()),
+            B = substitute(c.b()),
+            C = substitute(c.c());
+
+        FR a, b, k;
+        const bool
+            constA = isConstant(A, a),
+            constB = isConstant(B, b),
+            constC = isConstant(C, k);
+
+        if (constC) {
+            if (constA && constB && a * b == k) return TRIVIAL;
+
+            if (FR::zero() == k &&
+                ((constA && FR::zero() == a) || (constB && FR::zero() == b)))
+                return TRIVIAL;
+        }
+
+        out = R1CON(A, B, C);
+        return KEEP;
+    }
+
+    // pinned variables replaced by their values
+    R1LC substitute(const R1LC& a) const {
+        R1LC v;
+        FR k = FR::zero();
+        bool hasConstant = false;
+
+        for (const auto& t : a.terms()) {
+            if (! t.isVariable()) {
+                k = k + t.coeff();
+                hasConstant = true;
+
+            } else {
+                const auto it = m_pinned.find(t.index());
+                if (m_pinned.end() == it) {
+                    v.addTerm(t);
+                } else {
+                    k = k + t.coeff() * it->second;
+                    hasConstant = true;
+                }
+            }
+        }
+
+        if (hasConstant) v.addTerm(R1T(k));
+        return v;
+    }
+
+    // sum of terms if there are no variables
+    static bool isConstant(const R1LC& a, FR& k) {
+        k = FR::zero();
+        for (const auto& t : a.terms()) {
+            if (t.isVariable()) return false;
+            k = k + t.coeff();
+        }
+
+        return true;
+    }
+
+    // single variable term
+    static bool isVariable(const R1LC& a, std::size_t& x, FR& coeff) {
+        if (1 != a.terms().size() || ! a.terms()[0].isVariable()) return false;
+        x = a.terms()[0].index();
+        coeff = a.terms()[0].coeff();
+        return true;
+    }
+
+    // a * x * b == k, from R1C::setTrue() and setFalse()
+    static bool isPinned(const R1CON& c, std::size_t& x, FR& value) {
+        FR a, b, k;
+        if (! isConstant(c.c(), k)) return false;
+
+        if (! (isVariable(c.a(), x, a) && isConstant(c.b(), b)) &&
+            ! (isVariable(c.b(), x, a) && isConstant(c.a(), b)))
+            return false;
+
+        const FR ab = a * b;
+        if (FR::zero() == ab) return false;
+
+        value = k * inverse(ab);
+        return true;
+    }
+
+    // x * (1 - x) == 0, from rank1_booleanity()
+    static bool isBooleanity(const R1CON& c, std::size_t& x) {
+        FR k;
+        if (! isConstant(c.c(), k) || FR::zero() != k) return false;
+
+        return
+            isBooleanity(c.a(), c.b(), x) ||
+            isBooleanity(c.b(), c.a(), x);
+    }
+
+    static bool isBooleanity(const R1LC& a, const R1LC& b, std::size_t& x) {
+        FR coeff;
+        if (! isVariable(a, x, coeff) || FR::one() != coeff) return false;
+        if (2 != b.terms().size()) return false;
+
+        const FR minusOne = FR::zero() - FR::one();
+        bool hasOne = false, hasMinusX = false;
+        for (const auto& t : b.terms()) {
+            if (! t.isVariable())
+                hasOne = (FR::one() == t.coeff());
+            else
+                hasMinusX = (x == t.index() && minusOne == t.coeff());
+        }
+
+        return hasOne && hasMinusX;
+    }
+
+    bool m_error;
+    snarklib::HugeSystem<FR> m_hugeSystem;
+    std::size_t m_numInputs, m_numVariables, m_newCount;
+    std::size_t m_keepCount, m_trivialCount, m_booleanCount;
+    std::unordered_map<std::size_t, FR> m_pinned;
+    std::vector<std::size_t> m_newIndex;
+};
+
+} // namespace snarkfront
+
+#endif
@@ -2,7 +2,11 @@
 #define _SNARKFRONT_DSL_BASE_HPP_
 
 #include <array>
+#include <cassert>
+#include <climits>
 #include <cstdint>
+#include <type_traits>
+#include <utility>
 
 #include <snarkfront/Alg.hpp>
 #include <snarkfront/Alg_BigInt.hpp>
@@ -33,19 +37,108 @@ template <typename FR> using uint64_x = AST_Var<Alg_uint64<FR>>;
 template <typename FR> using bigint_x = AST_Var<Alg_BigInt<FR>>;
 template <typename FR> using field_x = AST_Var<Alg_Field<FR>>;
 
+////////////////////////////////////////////////////////////////////////////////
+// expression template arguments
+//
+// Operators with variables, constants, and expressions on both sides
+// return expression templates. Everything else (values, comparisons,
+// conversions, trees built at runtime) returns runtime operator nodes.
+//
+
+template <typename T>
+struct ExprArg { static const bool value = false; };
+
+template <typename ALG>
+struct ExprArg<AST_Var<ALG>> { static const bool value = true; typedef ALG AlgType; };
+
+template <typename ALG>
+struct ExprArg<AST_Const<ALG>> { static const bool value = true; typedef ALG AlgType; };
+
+template <typename ALG, typename L, typename R>
+struct ExprArg<AST_Expr<ALG, L, R>> { static const bool value = true; typedef ALG AlgType; };
+
+// X and Y are expression arguments of algebra A
+template <template <typename> class A,
+          typename X,
+          typename Y,
+          bool = ExprArg<X>::value && ExprArg<Y>::value>
+struct ExprMatch { static const bool value = false; };
+
+template <template <typename> class A, typename X, typename Y>
+struct ExprMatch<A, X, Y, true>
+{
+    typedef typename ExprArg<X>::AlgType ALG;
+
+    static const bool value =
+        std::is_same<ALG, typename ExprArg<Y>::AlgType>::value &&
+        std::is_same<ALG, A<typename ALG::FrType>>::value;
+};
+
+// operator result from forwarded arguments, no type if not a match
+// (second argument is ExprNone for unary operators)
+template <template <typename> class A,
+          typename X,
+          typename Y = ExprNone,
+          bool = ExprMatch<
+              A,
+              typename std::decay<X>::type,
+              typename std::conditional<
+                  std::is_same<Y, ExprNone>::value,
+                  typename std::decay<X>::type,
+                  typename std::decay<Y>::type>::type>::value>
+struct ExprResult {};
+
+template <template <typename> class A, typename X, typename Y>
+struct ExprResult<A, X, Y, true>
+{
+    typedef typename ExprArg<typename std::decay<X>::type>::AlgType AlgType;
+
+    typedef AST_Expr<AlgType,
+                     typename ExprLink<X>::type,
+                     typename ExprLink<Y>::type> type;
+};
+
+// shift and rotate by a constant, no type if not a match
+template <template <typename> class A,
+          typename X,
+          bool = ExprMatch<A,
+                           typename std::decay<X>::type,
+                           typename std::decay<X>::type>::value>
+struct ExprPermute {};
+
+template <template <typename> class A, typename X>
+struct ExprPermute<A, X, true>
+{
+    typedef typename ExprArg<typename std::decay<X>::type>::AlgType AlgType;
+
+    typedef AST_Expr<AlgType,
+                     typename ExprLink<X>::type,
+                     AST_Const<AlgType>> type;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // logical and bitwise complement
 //
 
-#define DEFN_CMPLMNT(ALG, OP)                   \
-    template <typename FR>                      \
-    AST_Op<Alg_ ## ALG<FR>>                     \
-    operator OP(                                \
-        const AST_Node<Alg_ ## ALG<FR>>& x)     \
-    {                                           \
-        return AST_Op<Alg_ ## ALG<FR>>(         \
-            Alg_ ## ALG<FR>::OpType::CMPLMNT,   \
-            x);                                 \
+#define DEFN_CMPLMNT(ALG, OP)                                           \
+    template <typename FR>                                              \
+    AST_Op<Alg_ ## ALG<FR>>                                             \
+    operator OP(                                                        \
+        const AST_Node<Alg_ ## ALG<FR>>& x)                             \
+    {                                                                   \
+        return AST_Op<Alg_ ## ALG<FR>>(                                 \
+            Alg_ ## ALG<FR>::OpType::CMPLMNT,                           \
+            x);                                                         \
+    }                                                                   \
+    template <typename X>                                               \
+    typename ExprResult<Alg_ ## ALG, X>::type                           \
+    operator OP(X&& x)                                                  \
+    {                                                                   \
+        typedef ExprResult<Alg_ ## ALG, X> T;                           \
+        return typename T::type(                                        \
+            T::AlgType::OpType::CMPLMNT,                                \
+            std::forward<X>(x),                                         \
+            ExprNone());                                                \
     }
 
     DEFN_CMPLMNT(bool, !)
@@ -92,6 +185,16 @@ template <typename FR> using field_x = AST_Var<Alg_Field<FR>>;
             Alg_ ## ALG<FR>::OpType:: ENUM,             \
             new AST_Const<Alg_ ## ALG<FR>>(x),          \
             y);                                         \
+    }                                                   \
+    template <typename X, typename Y>                   \
+    typename ExprResult<Alg_ ## ALG, X, Y>::type        \
+    operator OP(X&& x, Y&& y)                           \
+    {                                                   \
+        typedef ExprResult<Alg_ ## ALG, X, Y> T;        \
+        return typename T::type(                        \
+            T::AlgType::OpType:: ENUM,                  \
+            std::forward<X>(x),                         \
+            std::forward<Y>(y));                        \
     }
 
     DEFN_OP(bool, &&, AND)
@@ -141,6 +244,14 @@ AST_Op<Alg_Field<FR>> inverse(const AST_Node<Alg_Field<FR>>& x) {
 // bitwise shift and rotate
 //
 
+template <typename T>
+void permuteCheck(const BitwiseOps op, const unsigned int n) {
+#ifdef USE_ASSERT
+    if (BitwiseOps::ROTL == op || BitwiseOps::ROTR == op)
+        assert(n <= sizeof(typename T::ValueType) * CHAR_BIT);
+#endif
+}
+
 #define DEFN_PERMUTE(ALG, OP, ENUM)                             \
     template <typename FR>                                      \
     AST_Op<Alg_ ## ALG<FR>>                                     \
@@ -149,6 +260,17 @@ AST_Op<Alg_Field<FR>> inverse(const AST_Node<Alg_Field<FR>>& x) {
         const unsigned int n)                                   \
     {                                                           \
         return BitwiseAST<Alg_ ## ALG<FR>>:: ENUM(x, n);        \
+    }                                                           \
+    template <typename X>                                       \
+    typename ExprPermute<Alg_ ## ALG, X>::type                  \
+    OP(X&& x, const unsigned int n)                             \
+    {                                                           \
+        typedef typename ExprPermute<Alg_ ## ALG, X>::AlgType T; \
+        permuteCheck<T>(T::OpType:: ENUM, n);                   \
+        return typename ExprPermute<Alg_ ## ALG, X>::type(      \
+            T::OpType:: ENUM,                                   \
+            std::forward<X>(x),                                 \
+            AST_Const<T>(n));                                   \
     }
 
     DEFN_PERMUTE(uint8, operator<<, SHL)
@@ -224,17 +346,29 @@ AST_Op<Alg_Field<FR>> inverse(const AST_Node<Alg_Field<FR>>& x) {
     DEFN_CMP(Field, ==, EQ)
     DEFN_CMP(Field, !=, NEQ)
 
-    // declarative equality test, imperative inequality test
+    // declarative equality test, imperative inequality and ordering tests
     DEFN_CMP(uint8, ==, EQ)
     DEFN_CMP(uint8, !=, NEQ)
+    DEFN_CMP(uint8, <, LT)
+    DEFN_CMP(uint8, <=, LE)
+    DEFN_CMP(uint8, >, GT)
+    DEFN_CMP(uint8, >=, GE)
 
-    // declarative equality test, imperative inequality test
+    // declarative equality test, imperative inequality and ordering tests
     DEFN_CMP(uint32, ==, EQ)
     DEFN_CMP(uint32, !=, NEQ)
+    DEFN_CMP(uint32, <, LT)
+    DEFN_CMP(uint32, <=, LE)
+    DEFN_CMP(uint32, >, GT)
+    DEFN_CMP(uint32, >=, GE)
 
-    // declarative equality test, imperative inequality test
+    // declarative equality test, imperative inequality and ordering tests
     DEFN_CMP(uint64, ==, EQ)
     DEFN_CMP(uint64, !=, NEQ)
+    DEFN_CMP(uint64, <, LT)
+    DEFN_CMP(uint64, <=, LE)
+    DEFN_CMP(uint64, >, GT)
+    DEFN_CMP(uint64, >=, GE)
 
 #undef DEFN_CMP
 
@@ -354,10 +488,13 @@ AST_X< OUT >* _xword(const AST_Node< IN >& x,           \
 ////////////////////////////////////////////////////////////////////////////////
 // conditional operator (ternary)
 //
+// For unsigned words the select is evaluated when it is made, like a
+// comparison, so the result is an AST_X and not an AST_Op tree.
+//
 
 #define DEFN_TERNARY_UINT(N)                                            \
 template <typename FR>                                                  \
-AST_Op<Alg_uint ## N <FR>> ternary(                                     \
+AST_X<Alg_uint ## N <FR>> ternary(                                      \
     const AST_Node<Alg_bool<FR>>& b,                                    \
     const AST_Node<Alg_uint ## N <FR>>& x,                              \
     const AST_Node<Alg_uint ## N<FR>>& y)                               \
@@ -365,7 +502,7 @@ AST_Op<Alg_uint ## N <FR>> ternary(                                     \
     return BitwiseAST<Alg_uint ## N <FR>>::ternary(b, x, y);            \
 }                                                                       \
 template <typename FR>                                                  \
-AST_Op<Alg_uint ## N <FR>>* _ternary(                                   \
+AST_X<Alg_uint ## N <FR>>* _ternary(                                    \
     const AST_Node<Alg_bool<FR>>& b,                                    \
     const AST_Node<Alg_uint ## N <FR>>& x,                              \
     const AST_Node<Alg_uint ## N<FR>>& y)                               \
@@ -482,15 +619,17 @@ std::array<V, N> ternary(                       \
 ////////////////////////////////////////////////////////////////////////////////
 // array subscript
 //
+// Evaluated when it is made (one-hot selectors), result is an AST_X.
+//
 
 template <typename FR, std::size_t N>
-AST_Op<Alg_uint8<FR>> subscript(const std::array<std::uint8_t, N>& a,
+AST_X<Alg_uint8<FR>> subscript(const std::array<std::uint8_t, N>& a,
                                 const AST_Node<Alg_uint8<FR>>& idx) {
     return BitwiseAST<Alg_uint8<FR>>::lookuptable(a, idx);
 }
 
 template <typename FR, std::size_t N>
-AST_Op<Alg_uint8<FR>> subscript(const std::array<AST_Var<Alg_uint8<FR>>, N>& a,
+AST_X<Alg_uint8<FR>> subscript(const std::array<AST_Var<Alg_uint8<FR>>, N>& a,
                                 const AST_Node<Alg_uint8<FR>>& idx) {
     return BitwiseAST<Alg_uint8<FR>>::arraysubscript(a, idx);
 }
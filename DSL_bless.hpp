@@ -42,9 +42,7 @@ template <typename FR>
 void bless(bigint_x<FR>& x,
            const std::uint64_t a,
            const bool assert64bits = true) {
-    std::stringstream ss;
-    ss << a;
-    x.bless(ss.str());
+    x.bless(typename bigint_x<FR>::ValueType(a));
 
     if (assert64bits) {
         // prevent cheating - high 64-bits must be zero
@@ -125,7 +123,7 @@ void bless_internal(std::array<T, N>& x, const U& a, const bool bigEndian) {
     typedef typename T::FrType FR;
 
     const auto term_bits = TL<R1C<FR>>::singleton()->argBits(*a);
-    const auto split_bits = a->splitBits();
+    const std::vector<int> split_bits = a->splitBits();
 
     for (std::size_t i = 0; i < N; ++i) {
         const std::vector<typename T::R1T> term_vec(
@@ -141,7 +139,7 @@ void bless_internal(std::array<T, N>& x, const U& a, const bool bigEndian) {
 
         x[bigEndian ? N - 1 - i : i]
             .bless(value,
-                   TL<PowersOf2<FR>>::singleton()->getNumber(split_vec),
+                   TL<PowersOf256<FR>>::singleton()->getNumber(split_vec),
                    split_vec,
                    term_vec);
     }
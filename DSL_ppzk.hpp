@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <ostream>
 #include <string>
 
 #include <snarklib/PPZK_keypair.hpp>
@@ -11,7 +12,9 @@
 
 #include <snarkfront/Alg.hpp>
 #include <snarkfront/Alg_bool.hpp>
+#include <snarkfront/CircuitEstimate.hpp>
 #include <snarkfront/DSL_base.hpp>
+#include <snarkfront/Profiler.hpp>
 #include <snarkfront/R1C.hpp>
 #include <snarkfront/TLsingleton.hpp>
 
@@ -35,13 +38,32 @@ void write_files(const std::string& filePrefix, const std::size_t maxSize)
         ->writeFiles(filePrefix, maxSize);
 }
 
+// returns false if there was an error, or for cached files, the
+// circuit is not the same as the one which wrote them
 template <typename PAIRING>
-void finalize_files()
+bool finalize_files()
 {
-    TL<R1C<typename PAIRING::Fr>>::singleton()
+    return TL<R1C<typename PAIRING::Fr>>::singleton()
         ->finalizeFiles();
 }
 
+// reuse constraint system files written earlier by write_files() and
+// finalize_files() for the same circuit, only the witness is made
+// returns false if there are no such files
+template <typename PAIRING>
+bool cached_files(const std::string& filePrefix)
+{
+    return TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->useCachedFiles(filePrefix);
+}
+
+template <typename PAIRING>
+std::uint64_t structural_hash()
+{
+    return TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->structuralHash();
+}
+
 template <typename PAIRING>
 void reset()
 {
@@ -63,6 +85,109 @@ std::size_t variable_count()
         ->counterID();
 }
 
+template <typename PAIRING>
+void eliminate_subexpressions(const bool enable = true)
+{
+    TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->eliminateSubexpressions(enable);
+}
+
+template <typename PAIRING>
+void eliminate_subexpressions(const bool enable,
+                              const std::size_t maxTableEntries)
+{
+    TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->eliminateSubexpressions(enable, maxTableEntries);
+}
+
+template <typename PAIRING>
+std::size_t saved_constraints()
+{
+    return TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->savedConstraints();
+}
+
+template <typename PAIRING>
+std::size_t folded_constraints()
+{
+    return TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->foldedConstraints();
+}
+
+template <typename PAIRING>
+void linear_combinations(const std::size_t maxTerms)
+{
+    TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->linearCombinations(maxTerms);
+}
+
+template <typename PAIRING>
+void linear_combinations(const std::size_t maxTerms,
+                         const std::size_t maxTableTerms)
+{
+    TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->linearCombinations(maxTerms, maxTableTerms);
+}
+
+template <typename PAIRING>
+void witness_only(const bool enable = true)
+{
+    TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->witnessOnly(enable);
+}
+
+// circuit is only counted, use before any variables
+template <typename PAIRING>
+void count_only(const bool enable = true)
+{
+    TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->countOnly(enable);
+}
+
+// key pair size and cost after count_only() circuit, e.g. qap -n and
+// hodur/ppzk -e partitions
+template <typename PAIRING>
+CircuitEstimate<PAIRING> circuit_estimate(const std::size_t numWindowBlocks = 1,
+                                          const std::size_t numBlocks = 1)
+{
+    return CircuitEstimate<PAIRING>(
+        TL<R1C<typename PAIRING::Fr>>::singleton()->countTotals(),
+        numWindowBlocks,
+        numBlocks);
+}
+
+template <typename PAIRING>
+void profile_circuit(const bool enable = true)
+{
+    TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->profiler().enable(enable);
+}
+
+template <typename PAIRING>
+void profile_json(std::ostream& os)
+{
+    TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->profiler().writeJSON(os);
+}
+
+template <typename PAIRING>
+void profile_folded(std::ostream& os, const bool useTime = false)
+{
+    TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->profiler().writeFolded(os, useTime);
+}
+
+// named scope, e.g. profile_region<PAIRING> r("merkle.level");
+template <typename PAIRING>
+class profile_region : public ProfileRegion
+{
+public:
+    profile_region(const std::string& name)
+        : ProfileRegion(TL<R1C<typename PAIRING::Fr>>::singleton()->profiler(),
+                        name)
+    {}
+};
+
 template <typename PAIRING>
 snarklib::PPZK_Keypair<PAIRING> keypair()
 {
@@ -92,6 +217,22 @@ const snarklib::R1Witness<typename PAIRING::Fr>& witness()
         ->witness();
 }
 
+// record operations while the circuit is built, use before any variables
+template <typename PAIRING>
+void record_tape(const bool enable = true)
+{
+    TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->recordTape(enable);
+}
+
+// replay() makes the witness again from new inputs
+template <typename PAIRING>
+const WitnessTape<typename PAIRING::Fr>& witness_tape()
+{
+    return TL<R1C<typename PAIRING::Fr>>::singleton()
+        ->witnessTape();
+}
+
 template <typename PAIRING>
 snarklib::PPZK_Proof<PAIRING> proof(
     const snarklib::PPZK_ProvingKey<PAIRING>& key)
@@ -13,12 +13,38 @@ namespace snarkfront {
 DEFN_OPARGC(LogicalOps, LogicalOps::CMPLMNT == op ? 1 : 2)
 DEFN_OPARGC(ScalarOps, 2)
 DEFN_OPARGC(FieldOps, FieldOps::INV == op ? 1 : 2)
-DEFN_OPARGC(BitwiseOps, BitwiseOps::CMPLMNT == op ? 1 : 2)
+DEFN_OPARGC(BitwiseOps, BitwiseOps::CMPLMNT == op ? 1 : (isTernary(op) ? 3 : 2))
 DEFN_OPARGC(EqualityCmp, 2)
 DEFN_OPARGC(ScalarCmp, 2)
 
 #undef DEFN_OPARGC
 
+////////////////////////////////////////////////////////////////////////////////
+// returns true if order of input arguments does not matter
+//
+
+#define DEFN_COMMUTE(E, R) template <> bool isCommutative<E>(const E op) { return R; }
+
+DEFN_COMMUTE(LogicalOps, LogicalOps::CMPLMNT != op)
+DEFN_COMMUTE(ScalarOps, ScalarOps::SUB != op)
+DEFN_COMMUTE(FieldOps, FieldOps::ADD == op || FieldOps::MUL == op)
+DEFN_COMMUTE(BitwiseOps, BitwiseOps::CMPLMNT != op && BitwiseOps::CH != op && ! isPermute(op))
+
+#undef DEFN_COMMUTE
+
+////////////////////////////////////////////////////////////////////////////////
+// sign of last argument for linear operators, zero if not linear
+//
+
+#define DEFN_LINEAR(E, R) template <> int linearSign<E>(const E op) { return R; }
+
+DEFN_LINEAR(LogicalOps, LogicalOps::CMPLMNT == op ? -1 : 0)
+DEFN_LINEAR(ScalarOps, ScalarOps::ADD == op ? 1 : (ScalarOps::SUB == op ? -1 : 0))
+DEFN_LINEAR(FieldOps, FieldOps::ADD == op ? 1 : (FieldOps::SUB == op ? -1 : 0))
+DEFN_LINEAR(BitwiseOps, BitwiseOps::ADDMOD == op ? 1 : (BitwiseOps::CMPLMNT == op ? -1 : 0))
+
+#undef DEFN_LINEAR
+
 ////////////////////////////////////////////////////////////////////////////////
 // returns true for shift and rotate
 //
@@ -36,6 +62,94 @@ bool isPermute(const BitwiseOps op) {
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// returns true for choose, majority and three-way XOR
+//
+
+bool isTernary(const BitwiseOps op) {
+    switch (op) {
+    case (BitwiseOps::CH) :
+    case (BitwiseOps::MAJ) :
+    case (BitwiseOps::XOR3) :
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// printable names
+//
+
+#define DEFN_NAME(E, OP) case (E::OP) : return #E "::" #OP ;
+
+const char* opName(const LogicalOps op) {
+    switch (op) {
+    DEFN_NAME(LogicalOps, AND)
+    DEFN_NAME(LogicalOps, OR)
+    DEFN_NAME(LogicalOps, XOR)
+    DEFN_NAME(LogicalOps, SAME)
+    DEFN_NAME(LogicalOps, CMPLMNT)
+    }
+}
+
+const char* opName(const ScalarOps op) {
+    switch (op) {
+    DEFN_NAME(ScalarOps, ADD)
+    DEFN_NAME(ScalarOps, SUB)
+    DEFN_NAME(ScalarOps, MUL)
+    }
+}
+
+const char* opName(const FieldOps op) {
+    switch (op) {
+    DEFN_NAME(FieldOps, ADD)
+    DEFN_NAME(FieldOps, SUB)
+    DEFN_NAME(FieldOps, MUL)
+    DEFN_NAME(FieldOps, INV)
+    }
+}
+
+const char* opName(const BitwiseOps op) {
+    switch (op) {
+    DEFN_NAME(BitwiseOps, AND)
+    DEFN_NAME(BitwiseOps, OR)
+    DEFN_NAME(BitwiseOps, XOR)
+    DEFN_NAME(BitwiseOps, SAME)
+    DEFN_NAME(BitwiseOps, CMPLMNT)
+    DEFN_NAME(BitwiseOps, ADDMOD)
+    DEFN_NAME(BitwiseOps, MULMOD)
+    DEFN_NAME(BitwiseOps, SHL)
+    DEFN_NAME(BitwiseOps, SHR)
+    DEFN_NAME(BitwiseOps, ROTL)
+    DEFN_NAME(BitwiseOps, ROTR)
+    DEFN_NAME(BitwiseOps, CH)
+    DEFN_NAME(BitwiseOps, MAJ)
+    DEFN_NAME(BitwiseOps, XOR3)
+    }
+}
+
+const char* opName(const EqualityCmp op) {
+    switch (op) {
+    DEFN_NAME(EqualityCmp, EQ)
+    DEFN_NAME(EqualityCmp, NEQ)
+    }
+}
+
+const char* opName(const ScalarCmp op) {
+    switch (op) {
+    DEFN_NAME(ScalarCmp, EQ)
+    DEFN_NAME(ScalarCmp, NEQ)
+    DEFN_NAME(ScalarCmp, LT)
+    DEFN_NAME(ScalarCmp, LE)
+    DEFN_NAME(ScalarCmp, GT)
+    DEFN_NAME(ScalarCmp, GE)
+    }
+}
+
+#undef DEFN_NAME
+
 ////////////////////////////////////////////////////////////////////////////////
 // EQ --> SAME
 // NEQ --> XOR
@@ -15,7 +15,8 @@ enum class ScalarOps { ADD, SUB, MUL };
 enum class FieldOps { ADD, SUB, MUL, INV };
 enum class BitwiseOps { AND, OR, XOR, SAME, CMPLMNT,
                         ADDMOD, MULMOD,
-                        SHL, SHR, ROTL, ROTR };
+                        SHL, SHR, ROTL, ROTR,
+                        CH, MAJ, XOR3 };
 
 // comparison
 enum class EqualityCmp { EQ, NEQ };
@@ -24,9 +25,27 @@ enum class ScalarCmp { EQ, NEQ, LT, LE, GT, GE };
 // number of operator input arguments
 template <typename ENUM_OPS> std::size_t opArgc(const ENUM_OPS op);
 
+// returns true if order of input arguments does not matter
+template <typename ENUM_OPS> bool isCommutative(const ENUM_OPS op);
+
+// returns zero if operator is not linear, otherwise the sign of the last
+// argument: +1 for x + y, -1 for x - y and complement 1 - x
+template <typename ENUM_OPS> int linearSign(const ENUM_OPS op);
+
 // returns true for shift and rotate
 bool isPermute(const BitwiseOps op);
 
+// returns true for choose, majority and three-way XOR
+bool isTernary(const BitwiseOps op);
+
+// printable name, e.g. "BitwiseOps::XOR"
+const char* opName(const LogicalOps op);
+const char* opName(const ScalarOps op);
+const char* opName(const FieldOps op);
+const char* opName(const BitwiseOps op);
+const char* opName(const EqualityCmp op);
+const char* opName(const ScalarCmp op);
+
 // EQ --> SAME
 // NEQ --> XOR
 LogicalOps eqToLogical(const EqualityCmp op);
@@ -86,6 +105,33 @@ T evalOp(const BitwiseOps op, const T& x, const T& y)
     case (BitwiseOps::SHR) : return B::SHR(x, y);
     case (BitwiseOps::ROTL) : return B::ROTL(x, y);
     case (BitwiseOps::ROTR) : return B::ROTR(x, y);
+
+    // three argument operations with the last argument repeated
+    case (BitwiseOps::CH) : return y;
+    case (BitwiseOps::MAJ) : return y;
+    case (BitwiseOps::XOR3) : return x;
+    }
+}
+
+// evaluate three argument bitwise word operations (SHA-2 choose,
+// majority and three-way XOR)
+template <typename T>
+T evalOp(const BitwiseOps op, const T& x, const T& y, const T& z)
+{
+    typedef cryptl::BitwiseINT<T> B;
+
+    switch (op) {
+    case (BitwiseOps::CH) :
+        return B::XOR(B::AND(x, y), B::AND(B::CMPLMNT(x), z));
+
+    case (BitwiseOps::MAJ) :
+        return B::XOR(B::XOR(B::AND(x, y), B::AND(x, z)), B::AND(y, z));
+
+    case (BitwiseOps::XOR3) :
+        return B::XOR(B::XOR(x, y), z);
+
+    default :
+        return evalOp(op, x, y);
     }
 }
 
@@ -1,10 +1,19 @@
 #ifndef _SNARKFRONT_EVAL_AST_HPP_
 #define _SNARKFRONT_EVAL_AST_HPP_
 
+#include <cstdint>
+#include <memory>
 #include <stack>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <snarkfront/AST.hpp>
 #include <snarkfront/EnumOps.hpp>
+#include <snarkfront/Profiler.hpp>
+#include <snarkfront/R1C.hpp>
+#include <snarkfront/TLsingleton.hpp>
 
 namespace snarkfront {
 
@@ -12,54 +21,312 @@ namespace snarkfront {
 // evaluate abstract syntax trees
 //
 
+// values are moved on and off the stack
+template <typename ALG> using
+EvalStack = std::stack<ALG, std::vector<ALG>>;
+
 template <typename ALG>
 class EvalAST : public VisitAST<ALG>
 {
 public:
+    // each thread has one stack, an evaluator uses the part above
+    // where it started and nested evaluators must finish first
+    EvalAST()
+        : m_state(*TL<State>::singleton()),
+          m_base(m_state.values.size()),
+          m_chainBase(m_state.chain.size()),
+          m_walkedBase(m_state.walked.size()),
+          m_namedBase(m_state.named.size())
+    {}
+
+    // after an exception, reference counts and values kept for shared
+    // operators and named expressions would be stale (node addresses
+    // are reused), so everything this evaluator counted is cleared
+    // (after normal evaluation there is nothing left to clear)
+    ~EvalAST() {
+        while (m_state.values.size() > m_base)
+            m_state.values.pop();
+
+        m_state.chain.resize(m_chainBase);
+        m_state.work.clear();
+
+        auto& walked = m_state.walked;
+        for (std::size_t i = m_walkedBase; i < walked.size(); ++i) {
+            const auto p = walked[i];
+            if (p->m_evalRefs || p->m_evalShared) {
+                p->m_evalRefs = 0;
+                p->m_evalShared = false;
+                m_state.memo.erase(p);
+            }
+        }
+        walked.resize(m_walkedBase);
+
+        auto& named = m_state.named;
+        for (std::size_t i = m_namedBase; i < named.size(); ++i) {
+            if (m_state.exprRefs.erase(named[i]))
+                m_state.memo.erase(named[i]);
+        }
+        named.resize(m_namedBase);
+    }
+
+    EvalAST(const EvalAST&) = delete;
+    EvalAST& operator= (const EvalAST&) = delete;
+
     // circuit inputs and constants
     void visit(const AST_Const<ALG>& a) {
-        m_valueStack.push(*a);
+        m_state.values.push(*a);
     }
 
     // variables
     void visit(const AST_Var<ALG>& a) {
-        m_valueStack.push(*a);
+        m_state.values.push(*a);
     }
 
     // operators
     void visit(const AST_Op<ALG>& a) {
-        a.descendLeft(*this); // first argument
+        // root of a tree not seen yet
+        if (0 == a.m_evalRefs) share(a);
 
-        if (1 != opArgc(a.opType())) {
-            a.descendRight(*this); // second argument
+        // chain of first arguments is followed without recursion,
+        // stops at a shared operator that already has a value
+        auto& chain = m_state.chain;
+        const std::size_t base = chain.size();
+        auto p = std::addressof(a);
+        while (p && ! recall(p)) {
+            chain.push_back(p);
+            p = p->leftOp();
         }
 
-        evalStackOp(m_valueStack, a.opType());
+        if (! p) chain.back()->descendLeft(*this); // first argument of last one
+
+        while (chain.size() > base) {
+            const auto q = chain.back();
+            chain.pop_back();
+
+            if (1 != opArgc(q->opType())) {
+                q->descendRight(*this); // second argument
+            }
+
+            const ProfileOp prof(profiler(), opName(q->opType()));
+            evalStackOp(m_state.values, q->opType());
+
+            remember(q);
+        }
     }
 
     // foreign tree - comparison and type conversion
     void visit(const AST_X<ALG>& a) {
-        m_valueStack.push(*a);
+        m_state.values.push(*a);
+    }
+
+    // expression templates, shapes are static so the recursion is
+    // inlined, named expressions used more than once are evaluated once
+    // (also as arguments of operators, counted by share())
+    template <typename L, typename R>
+    void visit(const AST_Expr<ALG, L, R>& a) {
+        if (! m_state.exprRefs.empty() &&
+            m_state.exprRefs.count(std::addressof(a))) {
+            evalNamed(a);
+
+        } else {
+            shareExpr(a);
+            evalExpr(a);
+        }
+    }
+
+    EvalAST* evaluator() {
+        return this;
     }
 
     // return result after evaluation
     const ALG& result() const {
-        return m_valueStack.top();
+        return m_state.values.top();
+    }
+
+    // move result off the stack
+    ALG takeResult() {
+        ALG a = std::move(m_state.values.top());
+        m_state.values.pop();
+        return a;
     }
 
     // for comparison operators
     void push(const ALG& a) {
-        m_valueStack.push(a);
+        m_state.values.push(a);
+    }
+
+    // count references to operators in a tree before evaluating it,
+    // an operator reached more than once is only evaluated once, the
+    // same for expression template arguments of operators
+    // (trees evaluated together should all be counted first)
+    void share(const AST_Node<ALG>& a) {
+        auto& work = m_state.work;
+        if (a.asOp()) work.push_back(a.asOp());
+
+        while (! work.empty()) {
+            const auto p = work.back();
+            work.pop_back();
+
+            if (p->m_evalRefs++) {
+                p->m_evalShared = true;
+
+            } else {
+                m_state.walked.push_back(p);
+
+                const auto L = p->leftOp(), R = p->rightOp();
+                if (L)
+                    work.push_back(L);
+                else
+                    p->leftLink()->shareArg(*this);
+
+                if (1 != opArgc(p->opType())) {
+                    if (R)
+                        work.push_back(R);
+                    else
+                        p->rightLink()->shareArg(*this);
+                }
+            }
+        }
+    }
+
+    // named expression, or expression argument of operators, is
+    // counted each time and what is inside only the first time
+    template <typename L, typename R>
+    void shareNamed(const AST_Expr<ALG, L, R>& a) {
+        const void* p = std::addressof(a);
+        if (0 == m_state.exprRefs[p]++) {
+            m_state.named.push_back(p);
+            shareExpr(a);
+        }
     }
 
     template <typename ENUM_CMP>
     void compareOp(const ENUM_CMP op) {
-        evalStackCmp(m_valueStack, op);
+        const ProfileOp prof(profiler(), opName(op));
+        evalStackCmp(m_state.values, op);
     }
 
 private:
-    // evaluation stack
-    std::stack<ALG> m_valueStack;
+    static Profiler& profiler() {
+        return TL<R1C<typename ALG::FrType>>::singleton()->profiler();
+    }
+
+    template <typename L, typename R>
+    void evalExpr(const AST_Expr<ALG, L, R>& a) {
+        evalLink<L>(a.left());
+        evalLink<R>(a.right());
+
+        const ProfileOp prof(profiler(), opName(a.opType()));
+        evalStackOp(m_state.values, a.opType());
+    }
+
+    template <typename LINK>
+    void evalLink(const AST_Var<ALG>& a) {
+        m_state.values.push(*a);
+    }
+
+    template <typename LINK>
+    void evalLink(const AST_Const<ALG>& a) {
+        m_state.values.push(*a);
+    }
+
+    // second argument of unary operator
+    template <typename LINK>
+    void evalLink(const ExprNone&) {}
+
+    template <typename LINK, typename L, typename R>
+    void evalLink(const AST_Expr<ALG, L, R>& a) {
+        if (std::is_reference<LINK>::value)
+            evalNamed(a);
+        else
+            evalExpr(a);
+    }
+
+    // uses up one reference, value is kept until the last one
+    template <typename L, typename R>
+    void evalNamed(const AST_Expr<ALG, L, R>& a) {
+        const void* p = std::addressof(a);
+        const auto refs = --m_state.exprRefs[p];
+
+        const auto it = m_state.memo.find(p);
+        if (m_state.memo.end() != it) {
+            if (refs) {
+                m_state.values.push(it->second);
+
+            } else {
+                m_state.values.push(std::move(it->second));
+                m_state.memo.erase(it);
+            }
+
+        } else {
+            evalExpr(a);
+            if (refs) m_state.memo.emplace(p, m_state.values.top());
+        }
+
+        if (! refs) m_state.exprRefs.erase(p);
+    }
+
+    // count references to named expressions, does nothing (and
+    // compiles to nothing) if there are none
+    template <typename L, typename R>
+    void shareExpr(const AST_Expr<ALG, L, R>& a) {
+        shareLink<L>(a.left());
+        shareLink<R>(a.right());
+    }
+
+    template <typename LINK, typename T>
+    void shareLink(const T&) {}
+
+    template <typename LINK, typename L, typename R>
+    void shareLink(const AST_Expr<ALG, L, R>& a) {
+        if (std::is_reference<LINK>::value)
+            shareNamed(a);
+        else
+            shareExpr(a);
+    }
+
+    // uses up one reference, pushes value of shared operator if known
+    bool recall(const AST_Op<ALG>* p) {
+        --p->m_evalRefs;
+        if (! p->m_evalShared) return false;
+
+        const auto it = m_state.memo.find(p);
+        if (m_state.memo.end() == it) return false;
+
+        if (p->m_evalRefs) {
+            m_state.values.push(it->second);
+
+        } else {
+            // last reference
+            m_state.values.push(std::move(it->second));
+            m_state.memo.erase(it);
+            p->m_evalShared = false;
+        }
+
+        return true;
+    }
+
+    // keep value of shared operator for other references
+    void remember(const AST_Op<ALG>* p) {
+        if (p->m_evalRefs)
+            m_state.memo.emplace(p, m_state.values.top());
+        else
+            p->m_evalShared = false;
+    }
+
+    // evaluation stack, operator chains, shared operator and named
+    // expression values, reused by the thread (walked operators and
+    // named expressions are those counted, in order)
+    struct State {
+        EvalStack<ALG> values;
+        std::vector<const AST_Op<ALG>*> chain, work, walked;
+        std::vector<const void*> named;
+        std::unordered_map<const void*, ALG> memo;
+        std::unordered_map<const void*, std::size_t> exprRefs;
+    };
+
+    State& m_state;
+    const std::size_t m_base, m_chainBase, m_walkedBase, m_namedBase;
 };
 
 } // namespace snarkfront
@@ -0,0 +1,200 @@
+#ifndef _SNARKFRONT_PARALLEL_R1C_HPP_
+#define _SNARKFRONT_PARALLEL_R1C_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <snarkfront/R1C.hpp>
+#include <snarkfront/TLsingleton.hpp>
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// parallel circuit synthesis
+//
+// Independent sub-circuits are built on worker threads. Each one goes
+// into its own shard, the thread local Rank-1 collector with a reserved
+// range of variable IDs. Variables from the calling thread (and earlier
+// shards) may be used freely inside a sub-circuit as their IDs do not
+// overlap. Sub-circuit results may be used by the calling thread too,
+// until the shards are merged.
+//
+// When the circuit is complete (before keypair, proof, or finalizing
+// files) the shards are merged into the collector of the calling thread.
+// Variables are renumbered in shard order so the constraint system and
+// witness are the same no matter how threads were scheduled. Shards
+// made after a merge take new ID ranges, so sub-circuit variables kept
+// from before the merge are caught if used again (with USE_ASSERT).
+//
+// If a sub-circuit throws, all workers are joined, the calling thread
+// collector is restored, no shards from that call are kept, and the
+// exception from the first failed sub-circuit (in order) is rethrown.
+//
+
+template <typename FR>
+class ParallelR1C
+{
+public:
+    // each shard reserves span variable IDs
+    ParallelR1C(const std::size_t numThreads = std::thread::hardware_concurrency(),
+                const std::size_t span = std::size_t(1) << 40)
+        : m_numThreads(0 == numThreads ? 1 : numThreads),
+          m_span(span),
+          m_merged(0)
+    {}
+
+    // build each sub-circuit in its own shard
+    void synthesize(const std::vector<std::function<void ()>>& subCircuits) {
+#ifdef USE_ASSERT
+        // calling thread variables must fit below first shard
+        assert(TL<R1C<FR>>::singleton()->counterID() < m_span);
+#endif
+
+        const std::size_t first = m_shards.size();
+        m_shards.resize(first + subCircuits.size());
+
+        // calling thread collector is swapped out while it works as well
+        auto& RS = *TL<R1C<FR>>::singleton();
+        R1C<FR> caller = std::move(RS);
+        const RestoreCaller restore(RS, caller);
+
+        // first exception from each sub-circuit
+        std::vector<std::exception_ptr> errors(subCircuits.size());
+
+        std::atomic<std::size_t> next(0);
+        std::atomic<bool> failed(false);
+
+        const auto worker = [this, first, &caller, &next, &failed, &errors, &subCircuits] () {
+            auto& RS = *TL<R1C<FR>>::singleton();
+
+            std::size_t k;
+            while (! failed && (k = next++) < subCircuits.size()) {
+                const std::size_t idx = first + k;
+
+                try {
+                    RS.reserveIDs((m_merged + idx + 1) * m_span);
+                    RS.copySettings(caller);
+                    RS.importLinear(caller);
+                    subCircuits[k]();
+
+                    m_shards[idx] = std::move(RS);
+                } catch (...) {
+                    errors[k] = std::current_exception();
+                    failed = true;
+                }
+
+                RS.reset();
+            }
+        };
+
+        {
+            JoinThreads threads;
+            for (std::size_t i = 1; i < std::min(m_numThreads, subCircuits.size()); ++i)
+                threads.emplace_back(worker);
+
+            worker();
+        }
+
+        // drop shards of this call and rethrow in sub-circuit order
+        if (failed) {
+            m_shards.resize(first);
+
+            for (const auto& e : errors) {
+                if (e) std::rethrow_exception(e);
+            }
+        }
+
+        // sub-circuit results may be linear combinations
+        for (std::size_t k = 0; k < subCircuits.size(); ++k)
+            caller.importLinear(m_shards[first + k]);
+    }
+
+    // renumber shard variables after calling thread variables, in order
+    void merge() {
+        auto& RS = *TL<R1C<FR>>::singleton();
+
+        // variables created by calling thread keep their IDs
+        const std::size_t N = RS.counterID() - 1;
+#ifdef USE_ASSERT
+        assert(N < m_span);
+#endif
+
+        std::vector<std::size_t> offset;
+        offset.reserve(m_shards.size());
+
+        std::size_t total = N;
+        for (const auto& s : m_shards) {
+#ifdef USE_ASSERT
+            assert(s.variableCount() < m_span);
+#endif
+            offset.push_back(total);
+            total += s.variableCount();
+        }
+
+        const std::size_t span = m_span, merged = m_merged;
+        const auto func = [span, merged, &offset] (const std::size_t i) -> std::size_t {
+            if (i < span) return i;
+
+            // shard k has IDs after base (merged + k + 1) * span
+            const std::size_t k = i / span - 1 - merged;
+            return offset[k] + i - (merged + k + 1) * span;
+        };
+
+        RS.remapIndices(func);
+
+        for (const auto& s : m_shards)
+            RS.appendShard(s, func);
+
+        m_merged += m_shards.size();
+        m_shards.clear();
+
+        RS.retireIDs(span, (m_merged + 1) * span);
+    }
+
+    std::size_t numberShards() const {
+        return m_shards.size();
+    }
+
+private:
+    // puts the calling thread collector back on every exit
+    class RestoreCaller
+    {
+    public:
+        RestoreCaller(R1C<FR>& RS, R1C<FR>& caller)
+            : m_RS(RS), m_caller(caller)
+        {}
+
+        ~RestoreCaller() {
+            m_RS = std::move(m_caller);
+        }
+
+    private:
+        R1C<FR> &m_RS, &m_caller;
+    };
+
+    // workers are joined on every exit, never left running
+    class JoinThreads : public std::vector<std::thread>
+    {
+    public:
+        ~JoinThreads() {
+            for (auto& t : *this) {
+                if (t.joinable()) t.join();
+            }
+        }
+    };
+
+    const std::size_t m_numThreads, m_span;
+    std::size_t m_merged; // shards merged before, their IDs are not reused
+    std::vector<R1C<FR>> m_shards;
+};
+
+} // namespace snarkfront
+
+#endif
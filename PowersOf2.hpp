@@ -2,6 +2,7 @@
 #define _SNARKFRONT_POWERS_OF_2_HPP_
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <climits>
 #include <cstdint>
@@ -68,6 +69,93 @@ private:
     std::vector<T> m_lut; // index -> T(2^index)
 };
 
+// look up table for byte multiples of powers of 256 for field elements,
+// values convert to Montgomery form by addition (no text, no division)
+template <typename T>
+class PowersOf256
+{
+public:
+    // T(b * 2^(8 * index))
+    const T& lookUp(const std::size_t index, const std::uint8_t b)
+    {
+        // protect against huge index from accidental pointer argument
+#ifdef USE_ASSERT
+        assert(index < 128);
+#endif
+
+        for (std::size_t i = m_lut.size(); i <= index; ++i) {
+            std::array<T, 256> row;
+            row[0] = T::zero();
+            row[1] = (0 == i) ? T::one() : m_lut.back()[128] + m_lut.back()[128];
+
+            for (std::size_t j = 2; j < 256; ++j) {
+                row[j] = (j & 0x1)
+                    ? row[j - 1] + row[1]
+                    : row[j / 2] + row[j / 2];
+            }
+
+            m_lut.emplace_back(row);
+        }
+
+        return m_lut[index][b];
+    }
+
+    T getNumber(std::uint64_t a) {
+        T accum = T::zero();
+
+        std::size_t i = 0;
+        while (a) {
+            if (a & 0xff)
+                accum = accum + lookUp(i, a & 0xff);
+
+            a >>= 8;
+            ++i;
+        }
+
+        return accum;
+    }
+
+    // little-endian words
+    T getNumber(const std::uint64_t* a, const std::size_t n) {
+        T accum = T::zero();
+
+        for (std::size_t k = 0; k < n; ++k) {
+            for (std::size_t i = 0; i < 8; ++i) {
+                const std::uint8_t b = a[k] >> (8 * i);
+                if (b)
+                    accum = accum + lookUp(8 * k + i, b);
+            }
+        }
+
+        return accum;
+    }
+
+    // bits, least significant first
+    T getNumber(const std::vector<int>& bits) {
+        T accum = T::zero();
+
+        std::uint8_t b = 0;
+        std::size_t i = 0;
+        for (const int a : bits) {
+            if (a) b |= (1 << (i % 8));
+
+            if (7 == i % 8) {
+                if (b) accum = accum + lookUp(i / 8, b);
+                b = 0;
+            }
+
+            ++i;
+        }
+
+        if (b) accum = accum + lookUp(i / 8, b);
+
+        return accum;
+    }
+
+private:
+    std::vector<std::array<T, 256>> m_lut; // index -> T(b * 256^index)
+};
+
 // convert Boolean to one and zero
 bool zero_internal(const bool& dummy);
 bool one_internal(const bool& dummy);
@@ -82,6 +170,16 @@ static snarklib::Field<T, N> one_internal(const snarklib::Field<T, N>& dummy) {
     return snarklib::Field<T, N>::one();
 }
 
+template <mp_size_t N>
+static snarklib::BigInt<N> zero_internal(const snarklib::BigInt<N>& dummy) {
+    return snarklib::BigInt<N>::zero();
+}
+
+template <mp_size_t N>
+static snarklib::BigInt<N> one_internal(const snarklib::BigInt<N>& dummy) {
+    return snarklib::BigInt<N>(1);
+}
+
 template <typename T>
 T boolTo(const bool a) {
     T dummy;
@@ -191,7 +289,7 @@ void addover(UINT_N& a1, UINT_N& a0, const UINT_N& b)
 
     const UINT_N lowOriginal = low;
     low += b_bit;
-    if ((0 == low) && (-1 == lowOriginal)) ++high; // handle carry
+    if ((0 == low) && (UINT_N(-1) == lowOriginal)) ++high; // handle carry
 
     // accumulate result
     a1 += high;
@@ -0,0 +1,246 @@
+#include <utility>
+
+#include "snarkfront/Profiler.hpp"
+
+using namespace std;
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// circuit profiler
+//
+
+namespace {
+
+void addCount(Profiler::Count& a, const Profiler::Count& b) {
+    a.calls += b.calls;
+    a.constraints += b.constraints;
+    a.variables += b.variables;
+    a.terms += b.terms;
+    a.seconds += b.seconds;
+}
+
+void writeString(ostream& os, const string& a) {
+    os << '"';
+    for (const auto c : a) {
+        if ('"' == c || '\\' == c) os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+
+void writeCount(ostream& os, const Profiler::Count& a) {
+    os << "{\"calls\": " << a.calls
+       << ", \"constraints\": " << a.constraints
+       << ", \"variables\": " << a.variables
+       << ", \"terms\": " << a.terms
+       << ", \"seconds\": " << a.seconds << "}";
+}
+
+void writeCache(ostream& os, const Profiler::CacheCount& a) {
+    const size_t n = a.hits + a.misses;
+    os << "{\"hits\": " << a.hits
+       << ", \"misses\": " << a.misses
+       << ", \"rate\": " << (n ? double(a.hits) / n : 0.0) << "}";
+}
+
+template <typename T>
+void writeMap(ostream& os, const map<string, T>& a, void (*writeValue)(ostream&, const T&)) {
+    os << "{";
+    bool first = true;
+    for (const auto& p : a) {
+        os << (first ? "\n    " : ",\n    ");
+        writeString(os, p.first);
+        os << ": ";
+        writeValue(os, p.second);
+        first = false;
+    }
+    os << (first ? "}" : "\n  }");
+}
+
+} // namespace
+
+Profiler::Profiler()
+    : m_enabled(false),
+      m_total{0, 0, 0, 0, 0}
+{
+    update();
+}
+
+Profiler::Profiler(const Profiler& other)
+    : m_enabled(other.m_enabled),
+      m_frames(other.m_frames),
+      m_ops(other.m_ops),
+      m_regions(other.m_regions),
+      m_stacks(other.m_stacks),
+      m_caches(other.m_caches),
+      m_total(other.m_total)
+{
+    update();
+}
+
+Profiler::Profiler(Profiler&& other)
+    : m_enabled(other.m_enabled),
+      m_frames(move(other.m_frames)),
+      m_ops(move(other.m_ops)),
+      m_regions(move(other.m_regions)),
+      m_stacks(move(other.m_stacks)),
+      m_caches(move(other.m_caches)),
+      m_total(other.m_total)
+{
+    update();
+    other.clear();
+}
+
+Profiler& Profiler::operator= (const Profiler& other) {
+    if (this != &other) {
+        m_enabled = other.m_enabled;
+        m_frames = other.m_frames;
+        m_ops = other.m_ops;
+        m_regions = other.m_regions;
+        m_stacks = other.m_stacks;
+        m_caches = other.m_caches;
+        m_total = other.m_total;
+        update();
+    }
+
+    return *this;
+}
+
+Profiler& Profiler::operator= (Profiler&& other) {
+    if (this != &other) {
+        m_enabled = other.m_enabled;
+        m_frames = move(other.m_frames);
+        m_ops = move(other.m_ops);
+        m_regions = move(other.m_regions);
+        m_stacks = move(other.m_stacks);
+        m_caches = move(other.m_caches);
+        m_total = other.m_total;
+        update();
+        other.clear();
+    }
+
+    return *this;
+}
+
+void Profiler::enable(const bool on) {
+    m_enabled = on;
+}
+
+void Profiler::clear() {
+    m_frames.clear();
+    m_ops.clear();
+    m_regions.clear();
+    m_stacks.clear();
+    m_caches.clear();
+    m_total = Count{0, 0, 0, 0, 0};
+    update();
+}
+
+void Profiler::beginOp(const char* name) {
+    if (m_enabled) beginFrame(name, true);
+}
+
+void Profiler::endOp() {
+    if (m_enabled) endFrame(true);
+}
+
+void Profiler::beginRegion(const string& name) {
+    if (m_enabled) beginFrame(name, false);
+}
+
+void Profiler::endRegion() {
+    if (m_enabled) endFrame(false);
+}
+
+void Profiler::merge(const Profiler& other) {
+    for (const auto& p : other.m_ops) addCount(m_ops[p.first], p.second);
+    for (const auto& p : other.m_regions) addCount(m_regions[p.first], p.second);
+    for (const auto& p : other.m_stacks) addCount(m_stacks[p.first], p.second);
+    for (const auto& p : other.m_caches) {
+        m_caches[p.first].hits += p.second.hits;
+        m_caches[p.first].misses += p.second.misses;
+    }
+    addCount(m_total, other.m_total);
+}
+
+void Profiler::writeJSON(ostream& os) const {
+    os << "{\n  \"total\": ";
+    writeCount(os, m_total);
+    os << ",\n  \"operators\": ";
+    writeMap(os, m_ops, writeCount);
+    os << ",\n  \"regions\": ";
+    writeMap(os, m_regions, writeCount);
+    os << ",\n  \"caches\": ";
+    writeMap(os, m_caches, writeCache);
+    os << "\n}" << endl;
+}
+
+void Profiler::writeFolded(ostream& os, const bool useTime) const {
+    for (const auto& p : m_stacks) {
+        const size_t value = useTime
+            ? static_cast<size_t>(p.second.seconds * 1000000)
+            : p.second.constraints;
+
+        if (value) os << p.first << ' ' << value << endl;
+    }
+}
+
+void Profiler::beginFrame(const string& name, const bool isOp) {
+    const string& parent = m_frames.empty()
+        ? string("circuit")
+        : m_frames.back().stack;
+
+    m_frames.emplace_back(
+        Frame{name, parent + ";" + name, isOp, Clock::now(), 0, 0});
+
+    update();
+
+    ++m_stack->calls;
+    if (isOp)
+        ++m_op->calls;
+    else
+        ++m_region->calls;
+}
+
+void Profiler::endFrame(const bool isOp) {
+    // unmatched end, e.g. profiler was enabled inside the scope
+    if (m_frames.empty() || isOp != m_frames.back().isOp) return;
+
+    const auto& f = m_frames.back();
+    const double elapsed
+        = chrono::duration<double>(Clock::now() - f.start).count();
+
+    // exclusive time
+    m_stack->seconds += elapsed - f.childSeconds;
+    if (isOp)
+        m_op->seconds += elapsed - f.childSeconds;
+    else
+        m_region->seconds += elapsed - f.childRegionSeconds;
+
+    m_frames.pop_back();
+
+    if (! m_frames.empty()) {
+        m_frames.back().childSeconds += elapsed;
+        if (! isOp) m_frames.back().childRegionSeconds += elapsed;
+    }
+
+    update();
+}
+
+// counters for innermost operator, region, and stack
+void Profiler::update() {
+    const Frame *op = nullptr, *region = nullptr;
+    for (const auto& f : m_frames) {
+        if (f.isOp)
+            op = &f;
+        else
+            region = &f;
+    }
+
+    m_op = &m_ops[op ? op->name : string("other")];
+    m_region = &m_regions[region ? region->stack : string("circuit")];
+    m_stack = &m_stacks[m_frames.empty() ? string("circuit") : m_frames.back().stack];
+}
+
+} // namespace snarkfront
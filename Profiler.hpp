@@ -0,0 +1,159 @@
+#ifndef _SNARKFRONT_PROFILER_HPP_
+#define _SNARKFRONT_PROFILER_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// circuit profiler
+//
+// Constraints, variables, linear combination terms, and wall time are
+// counted by operator and by named region. Operators are the innermost
+// and regions are outer scopes, both nest. Counts are exclusive: a
+// constraint belongs to the innermost operator and region only. Time
+// outside of any operator or region is not measured. Named caches count
+// hits and misses.
+//
+
+class Profiler
+{
+public:
+    struct Count {
+        std::size_t calls, constraints, variables, terms;
+        double seconds;
+    };
+
+    struct CacheCount {
+        std::size_t hits, misses;
+    };
+
+    Profiler();
+
+    // counters point into the maps
+    Profiler(const Profiler& other);
+    Profiler(Profiler&& other);
+    Profiler& operator= (const Profiler& other);
+    Profiler& operator= (Profiler&& other);
+
+    void enable(const bool on);
+    bool enabled() const { return m_enabled; }
+
+    void clear();
+
+    // scopes must nest
+    void beginOp(const char* name);
+    void endOp();
+    void beginRegion(const std::string& name);
+    void endRegion();
+
+    void countConstraint(const std::size_t terms) {
+        if (m_enabled) {
+            for (auto p : { m_op, m_region, m_stack, &m_total }) {
+                ++p->constraints;
+                p->terms += terms;
+            }
+        }
+    }
+
+    void countVariable() {
+        if (m_enabled) {
+            for (auto p : { m_op, m_region, m_stack, &m_total })
+                ++p->variables;
+        }
+    }
+
+    // lookups in a named cache
+    void countCache(const char* name, const bool hit) {
+        if (m_enabled) {
+            auto& c = m_caches[name];
+            if (hit)
+                ++c.hits;
+            else
+                ++c.misses;
+        }
+    }
+
+    // add counts from another profiler (parallel shards)
+    void merge(const Profiler& other);
+
+    const std::map<std::string, Count>& operators() const { return m_ops; }
+    const std::map<std::string, Count>& regions() const { return m_regions; }
+    const Count& total() const { return m_total; }
+    const std::map<std::string, CacheCount>& caches() const { return m_caches; }
+
+    // operator, region, total, and cache counts
+    void writeJSON(std::ostream& os) const;
+
+    // one line per stack "circuit;region;op count" for flame graphs,
+    // count is constraints or microseconds
+    void writeFolded(std::ostream& os, const bool useTime = false) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Frame {
+        std::string name, stack;
+        bool isOp;
+        Clock::time_point start;
+        double childSeconds, childRegionSeconds;
+    };
+
+    void beginFrame(const std::string& name, const bool isOp);
+    void endFrame(const bool isOp);
+    void update();
+
+    bool m_enabled;
+    std::vector<Frame> m_frames;
+    std::map<std::string, Count> m_ops, m_regions, m_stacks;
+    std::map<std::string, CacheCount> m_caches;
+    Count m_total;
+    Count *m_op, *m_region, *m_stack;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// scoped operator and region
+//
+
+class ProfileOp
+{
+public:
+    ProfileOp(Profiler& p, const char* name)
+        : m_p(p.enabled() ? &p : nullptr)
+    {
+        if (m_p) m_p->beginOp(name);
+    }
+
+    ~ProfileOp() {
+        if (m_p) m_p->endOp();
+    }
+
+private:
+    Profiler* m_p;
+};
+
+class ProfileRegion
+{
+public:
+    ProfileRegion(Profiler& p, const std::string& name)
+        : m_p(p.enabled() ? &p : nullptr)
+    {
+        if (m_p) m_p->beginRegion(name);
+    }
+
+    ~ProfileRegion() {
+        if (m_p) m_p->endRegion();
+    }
+
+private:
+    Profiler* m_p;
+};
+
+} // namespace snarkfront
+
+#endif
@@ -1,12 +1,16 @@
 #ifndef _SNARKFRONT_R1C_HPP_
 #define _SNARKFRONT_R1C_HPP_
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
+#include <fstream>
 #include <istream>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -20,8 +24,12 @@
 #include <snarkfront/Counter.hpp>
 #include <snarkfront/EnumOps.hpp>
 #include <snarkfront/PowersOf2.hpp>
+#include <snarkfront/Profiler.hpp>
 #include <snarkfront/Rank1Ops.hpp>
 #include <snarkfront/TLsingleton.hpp>
+#include <snarkfront/WitnessFile.hpp>
+#include <snarkfront/WitnessTape.hpp>
+#include <snarkfront/WitnessValue.hpp>
 
 namespace snarkfront {
 
@@ -37,34 +45,33 @@ public:
         return m_FR;
     }
 
-    const std::string& operator[] (const std::size_t varIndex) const {
-        return m_str[varIndex - 1]; // subtract one to make absolute index
+    const WitnessValue& operator[] (const std::size_t varIndex) const {
+        return m_values[varIndex - 1]; // subtract one to make absolute index
     }
 
     void clear() {
         m_FR.clear();
-        m_str.clear();
+        m_values.clear();
     }
 
     bool empty() const {
         return
             m_FR.empty() ||
-            m_str.empty();
+            m_values.empty();
     }
 
     void checkpoint(const snarklib::R1Witness<FR>& a,
-                    const std::vector<std::pair<std::size_t, std::string>>& b) {
+                    const std::vector<std::pair<std::size_t, WitnessValue>>& b) {
         m_FR = a;
 
         for (const auto& p : b) {
             // subtract one to make absolute index
             const std::size_t idx = p.first - 1;
 
-            for (std::size_t i = m_str.size(); i <= idx; ++i) {
-                m_str.emplace_back("*"); // dummy value
-            }
+            if (m_values.size() <= idx)
+                m_values.resize(idx + 1); // no value
 
-            m_str[idx] = p.second;
+            m_values[idx] = p.second;
         }
     }
 
@@ -72,17 +79,18 @@ public:
         return m_FR.size();
     }
 
-    std::size_t sizeSTR() const {
-        return m_str.size();
+    std::size_t sizeValues() const {
+        return m_values.size();
     }
 
+    // typed values are decimal text in files
     void marshal_out(std::ostream& os) const {
         m_FR.marshal_out(os);
 
-        os << m_str.size() << std::endl;
+        os << m_values.size() << std::endl;
 
-        for (const auto& a : m_str)
-            os << a << ' ';
+        for (const auto& a : m_values)
+            os << a.str() << ' ';
     }
 
     bool marshal_in(std::istream& is) {
@@ -91,12 +99,13 @@ public:
         std::size_t numberElems;
         if (! (is >> numberElems)) return false;
 
-        m_str.clear();
-        m_str.reserve(numberElems);
+        m_values.clear();
+        m_values.reserve(numberElems);
         for (std::size_t i = 0; i < numberElems; ++i) {
             std::string value;
             if (! (is >> value)) return false;
-            m_str.emplace_back(value);
+            m_values.emplace_back();
+            if (! m_values.back().str(value)) return false;
         }
 
         // consume trailing space
@@ -106,9 +115,37 @@ public:
         return true;
     }
 
+    // binary file format, only variables with typed values are written
+    void marshal_out_raw(std::ostream& os) const {
+        std::vector<std::pair<std::size_t, WitnessValue>> values;
+        for (std::size_t i = 0; i < m_values.size(); ++i) {
+            if (! m_values[i].empty())
+                values.emplace_back(i + 1, m_values[i]);
+        }
+
+        marshal_out_witness(os, m_FR, values);
+    }
+
+    bool marshal_in(const WitnessFile<FR>& wf) {
+        clear();
+        if (! wf.loadWitness(m_FR)) return false;
+
+        for (std::size_t k = 0; k < wf.numberValues(); ++k) {
+            // subtract one to make absolute index
+            const std::size_t idx = wf.valueIndex(k) - 1;
+
+            if (m_values.size() <= idx)
+                m_values.resize(idx + 1); // no value
+
+            m_values[idx] = wf.value(k);
+        }
+
+        return true;
+    }
+
 private:
     snarklib::R1Witness<FR> m_FR;
-    std::vector<std::string> m_str;
+    std::vector<WitnessValue> m_values;
 };
 
 template <typename FR>
@@ -123,6 +160,31 @@ std::istream& operator>> (std::istream& is, R1Cowitness<FR>& a) {
     return is;
 }
 
+// read input file in either binary or text format
+template <typename FR>
+bool marshal_in_witness(R1Cowitness<FR>& a, const std::string& filename)
+{
+    const WitnessFile<FR> wf(filename);
+    if (wf.isBinary()) return a.marshal_in(wf);
+
+    std::ifstream ifs(filename);
+    return !!ifs && a.marshal_in(ifs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// constraint system size from a count only run
+//
+// Nonzero counts are variables used by A, B and C with A and B swapped
+// if beneficial. A includes the input consistency variables (constant
+// one and public inputs) added by the QAP.
+//
+
+struct R1Count
+{
+    std::size_t constraints, terms, variables, inputs;
+    std::size_t nonzeroA, nonzeroB, nonzeroC;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Rank-1 Collector
 //
@@ -135,32 +197,143 @@ public:
     typedef snarklib::R1Term<FR> R1T;
 
     R1C()
-        : m_swap_AB_if_beneficial(false)
+        : m_shardBase(0),
+          m_retiredBegin(0),
+          m_retiredEnd(0),
+          m_cse(false),
+          m_cseSaved(0),
+          m_cseTableMax(defaultCSETableMax()),
+          m_cseTableEntries(0),
+          m_linearMax(defaultLinearMax()),
+          m_linearCount(0),
+          m_linearTableMax(defaultLinearTableMax()),
+          m_linearTableTerms(0),
+          m_folded(0),
+          m_witnessOnly(false),
+          m_countOnly(false),
+          m_countConstraints(0),
+          m_countTerms(0),
+          m_countInputs(0),
+          m_hashing(false),
+          m_cached(false),
+          m_hash(0),
+          m_cachedHash(0),
+          m_nonzeroA(0),
+          m_nonzeroB(0),
+          m_swap_AB_if_beneficial(false),
+          m_recordTape(false)
     {}
 
     // constraint system written out to files as it is built
     void writeFiles(const std::string& filePrefix, const std::size_t maxSize) {
         m_constraintSystem.clearAppend(filePrefix, maxSize);
+        m_filePrefix = filePrefix;
+        m_hashing = true;
+        m_cached = false;
+    }
+
+    // constraint system files from an earlier run of the same circuit,
+    // constraints are only hashed to check nothing has changed
+    // returns true if ok, false if files are missing (must write them)
+    bool useCachedFiles(const std::string& filePrefix) {
+        std::ifstream ifs(hashFile(filePrefix));
+        std::uint64_t cachedHash;
+        if (!ifs || !(ifs >> std::hex >> cachedHash)) return false;
+
+        snarklib::HugeSystem<FR> S(filePrefix);
+        if (! S.loadIndex()) return false;
+
+        m_filePrefix = filePrefix;
+        m_hashing = true;
+        m_cached = true;
+        m_cachedHash = cachedHash;
+        return true;
     }
 
     // constraint system is finished, write final part to disk
-    // returns true if ok, false if there was an error
+    // returns true if ok, false if there was an error (or with cached
+    // files, the circuit is not the same)
     bool finalizeFiles() {
+        if (m_cached)
+            return structuralHash() == m_cachedHash;
+
         m_constraintSystem.finalize(input().sizeFR());
-        return !!m_constraintSystem;
+        if (! m_constraintSystem) return false;
+
+        std::ofstream ofs(hashFile(m_filePrefix));
+        if (!ofs) return false;
+        ofs << std::hex << structuralHash() << std::endl;
+        return !!ofs;
+    }
+
+    // constraints, number of variables and inputs
+    std::uint64_t structuralHash() const {
+        return rank1_hash(rank1_hash(m_hash, counterID() - 1), m_input.sizeFR());
+    }
+
+    // more variables in B than A, counted as constraints are added
+    // only keypair() and proof() in this process use the decision, it is
+    // not kept with files from writeFiles() which stay as written (the
+    // qap and ppzk tools do not swap A and B)
+    bool swapBeneficial() const {
+        return m_nonzeroB > m_nonzeroA;
     }
 
     void reset() {
         // variable indices
         m_counter.reset();
+        m_shardBase = 0;
+        m_retiredBegin = m_retiredEnd = 0;
+
+        // common subexpressions
+        m_cse = false;
+        m_cseSaved = 0;
+        m_cseTableMax = defaultCSETableMax();
+        m_cseTable.clear();
+        m_cseTableEntries = 0;
+
+        // linear combinations
+        m_linearMax = defaultLinearMax();
+        m_linearCount = 0;
+        m_linearTableMax = defaultLinearTableMax();
+        m_linearTableTerms = 0;
+        m_linear.clear();
+
+        // simplified bit operations
+        m_folded = 0;
+        m_complement.clear();
+
+        // bit decompositions of scalars
+        m_splitCache.clear();
+        m_addends.clear();
+
+        // constraint and variable accounting
+        m_profiler.enable(false);
+        m_profiler.clear();
+
+        // cached constraint system files
+        m_filePrefix.clear();
+        m_hashing = false;
+        m_cached = false;
+        m_hash = 0;
+        m_cachedHash = 0;
 
         // quadratic constraint system
+        m_witnessOnly = false;
+        m_countOnly = false;
+        m_countConstraints = 0;
+        m_countTerms = 0;
+        m_countInputs = 0;
+        for (auto& a : m_countABC) a = Touched();
+        clearAB();
         m_swap_AB_if_beneficial = false;
         m_constraintSystem.clear();
 
         // variable assignment witness
         m_witness_FR.clear();
-        m_witness_str.clear();
+        m_witness_val.clear();
+        m_recordTape = false;
+        m_tape.clear();
 
         // input witness for (de)marshalling
         m_input.clear();
@@ -170,12 +343,348 @@ public:
         return m_counter.peekID();
     }
 
+    // shard of a parallel circuit, variable IDs start after base
+    void reserveIDs(const std::size_t base) {
+        reset();
+        m_counter.reset(base);
+        m_shardBase = base;
+    }
+
+    // IDs of merged shards, terms from them must not be used again
+    // (checked with USE_ASSERT)
+    void retireIDs(const std::size_t begin, const std::size_t end) {
+        m_retiredBegin = begin;
+        m_retiredEnd = end;
+    }
+
+    std::size_t baseID() const {
+        return m_shardBase;
+    }
+
+    // number of variables created since reset
+    std::size_t variableCount() const {
+        return counterID() - 1 - m_shardBase;
+    }
+
+    // reuse results of identical operations instead of new constraints,
+    // once maxTableEntries results are kept no more are added (they last
+    // until reset, so this bounds memory for huge circuits)
+    void eliminateSubexpressions(const bool enable,
+                                 const std::size_t maxTableEntries = defaultCSETableMax()) {
+        m_cse = enable;
+        m_cseTableMax = maxTableEntries;
+        if (! enable) {
+            m_cseTable.clear();
+            m_cseTableEntries = 0;
+        }
+    }
+
+    // number of constraints (and variables) not created due to reuse
+    std::size_t savedConstraints() const {
+        return m_cseSaved;
+    }
+
+    // number of constraints (and variables) not created due to simplified
+    // bit operations with constants, idempotence and double complement
+    std::size_t foldedConstraints() const {
+        return m_folded;
+    }
+
+    // linear results (addition, subtraction, complement) are combinations
+    // of variables instead of new variables with constraints, a new
+    // variable is only made if more than maxTerms (zero turns this off)
+    // or once the combinations kept add up to maxTableTerms (they last
+    // until reset, so this bounds memory for huge circuits)
+    void linearCombinations(const std::size_t maxTerms,
+                            const std::size_t maxTableTerms = defaultLinearTableMax()) {
+        m_linearMax = maxTerms;
+        m_linearTableMax = maxTableTerms;
+    }
+
+    // only the witness and input checkpoint, no constraint system
+    // (other options must be the same as when the constraint system was
+    // made so variable indices agree)
+    void witnessOnly(const bool enable) {
+        m_witnessOnly = enable;
+    }
+
+    // constraints and variables are only counted, no constraint system
+    // and no witness (nothing to prove, for estimating size only)
+    void countOnly(const bool enable) {
+        m_countOnly = enable;
+    }
+
+    // operations making each variable are recorded for replay
+    void recordTape(const bool enable) {
+        m_recordTape = enable;
+    }
+
+    const WitnessTape<FR>& witnessTape() const {
+        return m_tape;
+    }
+
+    // totals from count only mode
+    R1Count countTotals() const {
+        const std::size_t
+            bound = counterID(),
+            inputs = m_countInputs;
+
+        R1Count a{m_countConstraints, m_countTerms, bound - 1, inputs,
+                  m_countABC[0].count(bound),
+                  m_countABC[1].count(bound),
+                  m_countABC[2].count(bound)};
+
+        // same decision as swapBeneficial()
+        const bool swapAB = a.nonzeroB > a.nonzeroA;
+        if (swapAB) std::swap(a.nonzeroA, a.nonzeroB);
+
+        // input consistency, constant one and inputs
+        const auto& A = m_countABC[swapAB ? 1 : 0];
+        for (std::size_t i = 0; i <= inputs; ++i) {
+            if (! A.touched(i)) ++a.nonzeroA;
+        }
+
+        return a;
+    }
+
+    // same circuit options as another collector (sub-circuit capture)
+    void copyOptions(const R1C& other) {
+        m_cse = other.m_cse;
+        m_cseTableMax = other.m_cseTableMax;
+        m_linearMax = other.m_linearMax;
+        m_linearTableMax = other.m_linearTableMax;
+        m_profiler.enable(other.m_profiler.enabled());
+    }
+
+    // same options and modes as another collector (parallel shards)
+    void copySettings(const R1C& other) {
+        copyOptions(other);
+        m_witnessOnly = other.m_witnessOnly;
+        m_countOnly = other.m_countOnly;
+        m_recordTape = other.m_recordTape;
+        m_hashing = other.m_hashing;
+        m_cached = other.m_cached;
+        m_retiredBegin = other.m_retiredBegin;
+        m_retiredEnd = other.m_retiredEnd;
+    }
+
+    // linear combinations made by another collector (parallel shards)
+    void importLinear(const R1C& other) {
+        for (const auto& p : other.m_linear) {
+            if (m_linear.insert(p).second)
+                m_linearTableTerms += p.second.terms().size();
+        }
+    }
+
+    // term as combination of variables, expanded if linear combination
+    snarklib::R1Combination<FR> expandTerm(const R1T& x) const {
+        snarklib::R1Combination<FR> LC;
+        appendLinear(LC, FR::one(), x);
+        return LC;
+    }
+
+    // constraint system as built (must not be written to files)
+    template <typename FUNC>
+    void forEachConstraint(FUNC func) const {
+        m_constraintSystem.mapLambda(
+            [&func] (const snarklib::R1System<FR>& S) {
+                for (const auto& c : S.constraints())
+                    func(c);
+            });
+    }
+
+    // counts by operator and region
+    Profiler& profiler() {
+        return m_profiler;
+    }
+
+    // linear combination terms are expanded before adding constraint
+    void addConstraint(const snarklib::R1Constraint<FR>& c) {
+        if (m_witnessOnly) return;
+
+        if (m_linear.empty()) {
+            emitConstraint(c);
+
+        } else {
+            emitConstraint(
+                snarklib::R1Constraint<FR>(expandLinear(c.a()),
+                                           expandLinear(c.b()),
+                                           expandLinear(c.c())));
+        }
+    }
+
+    // relocate variable indices in constraint system
+    template <typename FUNC>
+    void remapIndices(FUNC func) {
+#ifdef USE_ASSERT
+        assert(! m_swap_AB_if_beneficial);
+#endif
+        // A and B variables are counted again with new indices
+        clearAB();
+
+        for (auto& a : m_countABC)
+            a.remap(func);
+
+        m_tape.remap(func);
+
+        m_constraintSystem.mapLambda(
+            [this, &func] (snarklib::R1System<FR>& S) -> bool {
+                for (auto& c : S.constraints()) {
+                    c = rank1_remap(c, func);
+                    touchAB(c, -1);
+                }
+
+                return true;
+            });
+
+        for (auto& p : m_witness_val)
+            p.first = func(p.first);
+
+        for (auto& p : m_linear)
+            p.second = rank1_remap(p.second, func);
+
+        // table keys use old indices
+        m_cseTable.clear();
+        m_cseTableEntries = 0;
+        m_complement.clear();
+        m_splitCache.clear();
+        m_addends.clear();
+    }
+
+    // append constraints and witness from a shard, relocating indices
+    template <typename FUNC>
+    void appendShard(const R1C& shard, FUNC func) {
+#ifdef USE_ASSERT
+        assert(! m_swap_AB_if_beneficial);
+#endif
+        const std::size_t N = shard.variableCount();
+        if (0 == N) return;
+
+        // shards hash their own constraints, combined in shard order
+        if (m_hashing) m_hash = rank1_hash(m_hash, shard.m_hash);
+
+        if (! m_cached)
+            shard.m_constraintSystem.mapLambda(
+                [this, &func] (const snarklib::R1System<FR>& a) {
+                    for (const auto& c : a.constraints()) {
+                        const auto b = rank1_remap(c, func);
+                        touchAB(b, -1);
+                        m_constraintSystem.addConstraint(b);
+                    }
+                });
+
+        m_profiler.merge(shard.m_profiler);
+
+        if (m_countOnly) {
+            m_countConstraints += shard.m_countConstraints;
+            m_countTerms += shard.m_countTerms;
+            for (std::size_t i = 0; i < m_countABC.size(); ++i)
+                m_countABC[i].append(shard.m_countABC[i], func, shard.m_shardBase);
+
+        } else {
+            // shard witness is stored relative to its base ID
+            for (std::size_t i = 1; i <= N; ++i) {
+                m_witness_FR.assignVar(
+                    R1V(func(shard.m_shardBase + i)),
+                    shard.m_witness_FR[i]);
+            }
+
+            for (const auto& p : shard.m_witness_val)
+                m_witness_val.emplace_back(func(p.first), p.second);
+        }
+
+        if (m_recordTape) m_tape.append(shard.m_tape, func);
+
+        // shard variables now follow those already here
+        const std::size_t lastID = func(shard.m_shardBase + N);
+        if (lastID >= counterID())
+            m_counter.reset(lastID);
+    }
+
+    // instance of a sub-circuit captured over local variable indices,
+    // local variables 1 to args.size() are bound to the argument terms
+    // and the others are new variables with witness w (index 0 is one),
+    // returns terms for the outputs
+    std::vector<R1T> appendSubCircuit(
+        const std::vector<snarklib::R1Constraint<FR>>& constraints,
+        const WitnessTape<FR>& tape,
+        const std::vector<snarklib::R1Combination<FR>>& outputs,
+        const std::vector<R1T>& args,
+        const std::vector<FR>& w)
+    {
+        const ProfileOp prof(m_profiler, "subcircuit");
+
+        const std::size_t
+            N = args.size(),
+            offset = counterID() - 1 - N;
+
+        std::vector<snarklib::R1Combination<FR>> argLC;
+        argLC.reserve(N);
+        for (const auto& a : args)
+            argLC.emplace_back(expandTerm(a));
+
+        for (std::size_t i = N + 1; i < w.size(); ++i)
+            createTerm(w[i], true);
+
+        const auto bind = [N, offset, &argLC] (const snarklib::R1Combination<FR>& a) {
+            snarklib::R1Combination<FR> LC;
+            LC.reserveTerms(a.terms().size());
+
+            for (const auto& t : a.terms()) {
+                const std::size_t i = t.index();
+                if (0 == i) {
+                    LC.addTerm(t);
+
+                } else if (i > N) {
+                    LC.addTerm(t.coeff() * R1V(offset + i));
+
+                } else {
+                    for (const auto& u : argLC[i - 1].terms()) {
+                        if (u.isVariable())
+                            LC.addTerm((t.coeff() * u.coeff()) * u.var());
+                        else
+                            LC.addTerm(R1T(t.coeff() * u.coeff()));
+                    }
+                }
+            }
+
+            return LC;
+        };
+
+        if (! m_witnessOnly) {
+            for (const auto& c : constraints)
+                emitConstraint(
+                    snarklib::R1Constraint<FR>(bind(c.a()), bind(c.b()), bind(c.c())));
+        }
+
+        if (m_recordTape) m_tape.instance(tape, N, offset, bind);
+
+        std::vector<R1T> z;
+        z.reserve(outputs.size());
+        for (const auto& LC : outputs) {
+            const auto b = bind(LC);
+            if (b.terms().size() <= 1) {
+                z.push_back(b.terms().empty() ? R1T() : b.terms()[0]);
+
+            } else {
+                FR value = FR::zero();
+                for (const auto& t : LC.terms())
+                    value = value + t.coeff() * w[t.index()];
+
+                z.push_back(linearTerm(b, value));
+            }
+        }
+
+        return z;
+    }
+
     // mark end of public circuit inputs known to prover and verifier
     void checkpointInput() {
         // assumes all inputs are first
+        m_countInputs = counterID() - 1;
         m_input.checkpoint(
             m_witness_FR,
-            m_witness_str);
+            m_witness_val);
     }
 
     const R1Cowitness<FR>& input() const {
@@ -187,6 +696,9 @@ public:
     snarklib::PPZK_Keypair<PAIRING> keypair(
         snarklib::ProgressCallback* callback = nullptr)
     {
+#ifdef USE_ASSERT
+        assert(! m_witnessOnly && ! m_countOnly && ! m_cached);
+#endif
         swap_AB_if_beneficial();
 
         return snarklib::PPZK_Keypair<PAIRING>(
@@ -208,6 +720,9 @@ public:
         const std::size_t reserveTune,
         snarklib::ProgressCallback* callback = nullptr)
     {
+#ifdef USE_ASSERT
+        assert(! m_witnessOnly && ! m_countOnly && ! m_cached);
+#endif
         swap_AB_if_beneficial();
 
         return snarklib::PPZK_Proof<PAIRING>(
@@ -258,6 +773,7 @@ public:
         if (nonzeroIndex) {
             R1V x(m_counter.uniqueID());
             addWitness(x, a);
+            m_profiler.countVariable();
             return x; // x_i
 
         } else {
@@ -269,15 +785,20 @@ public:
         return createTerm(a, false);
     }
 
-    template <typename VAL>
-    void witnessTerms(const std::vector<R1T>& r1Terms, const VAL& value) {
-        std::stringstream ss;
-        ss << value;
-        addWitness(r1Terms, ss.str());
+    // typed value of input, kept in binary
+    template <typename TERMS, typename VAL>
+    void witnessTerms(const TERMS& r1Terms, const VAL& value) {
+        if (m_countOnly) return;
+        m_witness_val.emplace_back(r1Terms.begin()->index(), WitnessValue(value));
+
+        if (m_recordTape)
+            m_tape.input(r1Terms.begin()->index(), r1Terms.size(), WitnessValue(value));
     }
 
     void addBooleanity(const R1T& x) {
-        rank1_booleanity(m_constraintSystem, x);
+        if (m_witnessOnly) return;
+        const ProfileOp prof(m_profiler, "booleanity");
+        rank1_booleanity(*this, x);
     }
 
     void setTrue(const R1T& x) {
@@ -292,27 +813,45 @@ public:
     witnessToBits(const R1T& x,
                   const std::vector<int>& splitBits)
     {
+        const bool isVar = x.isVariable();
+
+        // scalar variable is split at most once
+        if (isVar) {
+            const auto it = m_splitCache.find(x.index());
+            const bool hit =
+                m_splitCache.end() != it &&
+                it->second.coeff == x.coeff() &&
+                it->second.bits.size() == splitBits.size();
+
+            m_profiler.countCache("split", hit);
+            if (hit) return it->second.bits;
+        }
+
         std::vector<R1T> v;
         v.reserve(splitBits.size());
 
-        const bool isVar = x.isVariable();
-
         for (const auto& b : splitBits) {
             v.emplace_back(
                 createTerm(boolTo<FR>(b), isVar));
         }
 
         if (isVar) {
+            if (m_recordTape && ! v.empty())
+                m_tape.split(v[0].index(), v.size(), expandTerm(x));
+
             addSplit(x, v);
 
             for (const auto& b : v)
                 addBooleanity(b);
+
+            m_splitCache[x.index()] = Split_Entry{x.coeff(), v};
         }
 
         return v;
     }
 
-    R1T bitsToWitness(const std::vector<R1T>& splitTerms,
+    template <typename TERMS>
+    R1T bitsToWitness(const TERMS& splitTerms,
                       const FR& value)
     {
         bool isVar = false;
@@ -321,15 +860,62 @@ public:
                 isVar = true;
         }
 
+        if (isVar && m_linearMax) {
+            // scalar is linear combination of the bits
+            snarklib::R1Combination<FR> LC;
+            for (std::size_t i = 0; i < splitTerms.size(); ++i) {
+                if (! splitTerms[i].zeroTerm())
+                    appendLinear(LC,
+                                 TL<PowersOf2<FR>>::singleton()->lookUp(i),
+                                 splitTerms[i]);
+            }
+
+            return linearTerm(LC, value);
+        }
+
         const auto x = createTerm(value, isVar);
 
         if (isVar) {
+            if (m_recordTape) {
+                snarklib::R1Combination<FR> LC;
+                for (std::size_t i = 0; i < splitTerms.size(); ++i)
+                    appendLinear(LC,
+                                 TL<PowersOf2<FR>>::singleton()->lookUp(i),
+                                 splitTerms[i]);
+
+                m_tape.linear(x.index(), LC);
+            }
+
             addSplit(x, splitTerms);
         }
 
         return x;
     }
 
+    // number of words summed in a scalar from modulo addition, so a sum
+    // of k words has only ceil(log2(k)) carry bits however it was added.
+    // A scalar split into wordBits + h bits is less than 2^(wordBits+h),
+    // i.e. 2^h words of all ones and a remainder less than one word, so
+    // it is never more than 2^h + 1 words whether a count was recorded
+    // for it or not. A product (split into 2 * wordBits bits) is reduced
+    // to one word before it is added.
+    std::size_t addendCount(const R1T& x,
+                            const std::size_t wordBits,
+                            const std::size_t splitBits) const {
+        if (splitBits <= wordBits || splitBits >= 2 * wordBits) return 1;
+
+        const std::size_t widthCount = (std::size_t(1) << (splitBits - wordBits)) + 1;
+
+        const auto it = m_addends.find(x.index());
+        return (m_addends.end() != it && FR::one() == x.coeff())
+            ? std::min(it->second, widthCount)
+            : widthCount;
+    }
+
+    void setAddendCount(const R1T& z, const std::size_t k) {
+        if (z.isVariable()) m_addends[z.index()] = k;
+    }
+
     // argument as scalar, converts bit representation as necessary
     template <typename ALG>
     R1T argScalar(const ALG& arg) {
@@ -365,9 +951,24 @@ public:
         // For other types, sizeBits(dummy) is greater than 1 so
         // conditional is equivalent to: 1 == termCnt. In the case of
         // uint8/32/64, this will be true only for ADDMOD and MULMOD.
-        return ((1 == termCnt) && (sizeBits(dummy) != termCnt))
-            ? witnessToBits(arg.r1Terms()[0], arg.splitBits())
-            : arg.r1Terms();
+        if ((1 == termCnt) && (sizeBits(dummy) != termCnt))
+            return witnessToBits(arg.r1Terms()[0], arg.splitBits());
+        else
+            return arg.r1Terms();
+    }
+
+    // argument as scalar of its value, any overflow from modulo
+    // addition is split off
+    template <typename ALG>
+    R1T argPacked(const ALG& arg) {
+        typename ALG::ValueType dummy;
+
+        if (arg.splitBits().size() <= sizeBits(dummy))
+            return argScalar(arg);
+
+        const auto b = argBits(arg);
+        return bitsToWitness(rank1_xword(b, sizeBits(dummy)),
+                             ALG::valueToField(arg.value()));
     }
 
     // create constant or variable for operation result
@@ -378,9 +979,7 @@ public:
 
         } else {
             // at least one of x and y is a variable
-            const R1T z = createVariable(witness);
-            addConstraint(op, x, y, z);
-            return z;
+            return createBits(op, x, y, witness);
         }
     }
 
@@ -392,9 +991,7 @@ public:
 
         } else {
             // at least one of x and y is a variable
-            const R1T z = createVariable(witness);
-            addConstraint(op, x, y, z);
-            return z;
+            return createVariable(op, x, y, witness);
         }
     }
 
@@ -406,9 +1003,7 @@ public:
 
         } else {
             // at least one of x and y is a variable
-            const R1T z = createVariable(witness);
-            addConstraint(op, x, y, z);
-            return z;
+            return createVariable(op, x, y, witness);
         }
     }
 
@@ -418,6 +1013,10 @@ public:
             // x and y are constant
             return createConstant(witness);
 
+        } else if (BitwiseOps::ADDMOD != op && BitwiseOps::MULMOD != op) {
+            // AND, OR, XOR, SAME, CMPLMNT (shifts leave null bits)
+            return createBits(op, x, y, witness);
+
         } else if (x.zeroTerm()) {
             // shifts leave null bits
             return otherTermZero(op, y);
@@ -428,10 +1027,73 @@ public:
 
         } else {
             // at least one of x and y is a variable
-            const R1T z = createVariable(witness);
-            addConstraint(op, x, y, z);
-            return z;
+            return createVariable(op, x, y, witness);
+        }
+    }
+
+    // z = OP(x[0], x[1], x[2]) for CH, MAJ, XOR3 on bits with values b,
+    // constant and repeated arguments fold to binary operations
+    R1T createResult(const BitwiseOps op,
+                     const std::array<R1T, 3>& x,
+                     const std::array<int, 3>& b)
+    {
+        const FR witness = boolTo<FR>(evalOp<std::uint8_t>(op, b[0], b[1], b[2]) & 0x1);
+
+        if (! x[0].isVariable() && ! x[1].isVariable() && ! x[2].isVariable()) {
+            // x[0], x[1] and x[2] are constant
+            return createConstant(witness);
+        }
+
+        const auto same = [] (const R1T& s, const R1T& t) {
+            return s.index() == t.index() && s.coeff() == t.coeff();
+        };
+
+        if (BitwiseOps::CH == op) {
+            if (! x[0].isVariable()) {
+                // CH(1, y, z) == y, CH(0, y, z) == z
+                ++m_folded;
+                return (FR::one() == x[0].coeff()) ? x[1] : x[2];
+            }
+
+            if (same(x[1], x[2])) {
+                // CH(x, y, y) == y
+                ++m_folded;
+                return x[1];
+            }
+
+        } else {
+            for (std::size_t k = 0; k < 3; ++k) {
+                const R1T
+                    &c = x[k],
+                    &s = x[(k + 1) % 3],
+                    &t = x[(k + 2) % 3];
+
+                if (! c.isVariable()) {
+                    ++m_folded;
+                    const bool isOne = (FR::one() == c.coeff());
+
+                    // MAJ(1, s, t) == s | t, MAJ(0, s, t) == s & t
+                    if (BitwiseOps::MAJ == op)
+                        return createResult(isOne ? BitwiseOps::OR : BitwiseOps::AND,
+                                            s, t, witness);
+
+                    // XOR3(c, s, t) == c ^ s ^ t
+                    const R1T st = createResult(BitwiseOps::XOR, s, t,
+                                                boolTo<FR>(b[(k + 1) % 3] != b[(k + 2) % 3]));
+                    return isOne
+                        ? createResult(BitwiseOps::CMPLMNT, st, st, witness)
+                        : st;
+                }
+
+                if (same(s, t)) {
+                    // MAJ(c, s, s) == s, XOR3(c, s, s) == c
+                    ++m_folded;
+                    return (BitwiseOps::MAJ == op) ? s : c;
+                }
+            }
         }
+
+        return createVariable(op, x, b, witness);
     }
 
     // shift and rotate
@@ -481,15 +1143,16 @@ public:
 
         // z is result
         const auto z = createVariable(boolTo<FR>(zbit));
+        if (m_recordTape) m_tape.linear(z.index(), expandTerm(boolTo<FR>(zbit)));
 
         // (N - x[0] + x[1] +...+ x[N-1]) * z == 0
-        m_constraintSystem.addConstraint(
+        addConstraint(
             (N - inputs) * z == FR::zero());
 
         // (N - x[0] + x[1] +...+ x[N-1]) * INV == 1 - z
         // If z == 1, then INV = 0
         // If z == 0, then INV = inverse(N - x[0] + x[1] +...+ x[N-1])
-        m_constraintSystem.addConstraint(
+        addConstraint(
             inputs * (zbit ? FR::zero() : inverse(N - xsum_witness)) == FR::one() - z);
 
         return z;
@@ -529,15 +1192,16 @@ public:
 
         // z is result
         const auto z = createVariable(boolTo<FR>(zbit));
+        if (m_recordTape) m_tape.linear(z.index(), expandTerm(boolTo<FR>(zbit)));
 
         // (x[0] + x[1] +...+ x[N-1]) * (1 - z) == 0
-        m_constraintSystem.addConstraint(
+        addConstraint(
             inputs * (FR::one() - z) == FR::zero());
 
         // (x[0] + x[1] +...+ x[N-1]) * INV == z
         // If z == 1, then INV = inverse(x[0] + x[1] +...+ x[N-1])
         // If z == 0, then INV = 0
-        m_constraintSystem.addConstraint(
+        addConstraint(
             inputs * (zbit ? inverse(xsum_witness) : FR::zero()) == z);
 
         return z;
@@ -574,7 +1238,169 @@ public:
         return imperative_GATE(LogicalOps::XOR, x, witness);
     }
 
+    // z = (x == y) for scalars, difference times inverse
+    // validity requires x == y, same as declarative_AND() of equal bits,
+    // so z is always one and the inverse term drops out
+    R1T declarative_EQ(const R1T& x, const R1T& y) {
+        snarklib::R1Combination<FR> d;
+        appendLinear(d, FR::one(), x);
+        appendLinear(d, FR::zero() - FR::one(), y);
+
+        // (x - y) * z == 0, z == 1
+        addConstraint(
+            d * FR::one() == FR::zero());
+
+        return createConstant(FR::one());
+    }
+
+    // z = (x != y) for scalars, difference times inverse
+    // dwitness is x - y
+    R1T imperative_NEQ(const R1T& x, const R1T& y, const FR& dwitness) {
+        const bool zbit = FR::zero() != dwitness;
+
+        if (! x.isVariable() && ! y.isVariable())
+            return createConstant(boolTo<FR>(zbit));
+
+        snarklib::R1Combination<FR> d;
+        appendLinear(d, FR::one(), x);
+        appendLinear(d, FR::zero() - FR::one(), y);
+
+        // If z == 1, then INV = inverse(x - y)
+        // If z == 0, then INV = 0
+        const auto inv = createVariable(zbit ? inverse(dwitness) : FR::zero());
+        const auto z = createVariable(boolTo<FR>(zbit));
+        if (m_recordTape) {
+            m_tape.op(FieldOps::INV, inv.index(), d, snarklib::R1Combination<FR>());
+            m_tape.op(ScalarOps::MUL, z.index(), d, expandTerm(inv));
+        }
+
+        // (x - y) * (1 - z) == 0
+        addConstraint(
+            d * (FR::one() - z) == FR::zero());
+
+        // (x - y) * INV == z
+        addConstraint(
+            d * inv == z);
+
+        return z;
+    }
+
+    // z = (x > y) if strict, otherwise z = (x >= y), for scalars less
+    // than 2^n, high bit of 2^n + x - y - strict split into n + 1 bits
+    R1T imperative_GE(const R1T& x, const R1T& y,
+                      const FR& xwitness, const FR& ywitness,
+                      const std::size_t n, const bool strict)
+    {
+        const FR offset = TL<PowersOf2<FR>>::singleton()->lookUp(n) - boolTo<FR>(strict);
+        const FR dwitness = offset + xwitness - ywitness;
+
+        // 0 <= 2^n + x - y - strict < 2^(n + 1)
+        std::vector<int> dbits = valueBits(dwitness);
+        dbits.resize(n + 1);
+
+        if (! x.isVariable() && ! y.isVariable())
+            return createConstant(boolTo<FR>(dbits[n]));
+
+        const R1T d = sumTerms({ R1T(offset), x, y },
+                               { FR::one(), FR::one(), FR::zero() - FR::one() },
+                               dwitness,
+                               false);
+
+        return witnessToBits(d, dbits)[n];
+    }
+
+    // s[j] = (idx == j) for j < N, index bits least significant first
+    // one-hot decoder tree from most significant bit, each selector is
+    // split by the next bit with one AND (the other half is linear),
+    // subtrees with no index below N are never made (so there are
+    // min(N, 2^bits) selectors, larger indices are out of reach)
+    std::vector<R1T> oneHot(const std::vector<R1T>& idxBits,
+                            const std::size_t idx,
+                            const std::size_t N)
+    {
+#ifdef USE_ASSERT
+        assert(idxBits.size() <= 64);
+#endif
+        std::vector<R1T> s{ R1T(FR::one()) };
+        std::vector<std::size_t> prefix{ 0 };
+
+        for (std::size_t p = idxBits.size(); p-- > 0; ) {
+            const R1T& b = idxBits[p];
+            const std::size_t idxPrefix = idx >> p;
+
+            std::vector<R1T> s2;
+            std::vector<std::size_t> prefix2;
+            for (std::size_t k = 0; k < s.size(); ++k) {
+                const std::size_t c0 = 2 * prefix[k], c1 = c0 + 1;
+                const bool
+                    keep0 = (c0 << p) < N,
+                    keep1 = (c1 << p) < N;
+
+                const R1T s1 = createResult(LogicalOps::AND, s[k], b,
+                                            boolTo<FR>(c1 == idxPrefix));
+
+                if (keep0) {
+                    snarklib::R1Combination<FR> LC;
+                    appendLinear(LC, FR::one(), s[k]);
+                    appendLinear(LC, FR::zero() - FR::one(), s1);
+                    s2.push_back(sumTerm(LC, boolTo<FR>(c0 == idxPrefix), false));
+                    prefix2.push_back(c0);
+                }
+
+                if (keep1) {
+                    s2.push_back(s1);
+                    prefix2.push_back(c1);
+                }
+            }
+
+            s.swap(s2);
+            prefix.swap(prefix2);
+        }
+
+        return s;
+    }
+
+    // z = c[0] * x[0] + c[1] * x[1] + ..., linear combination unless
+    // too long or newVariable (one constraint for many uses)
+    R1T sumTerms(const std::vector<R1T>& x,
+                 const std::vector<FR>& c,
+                 const FR& witness,
+                 const bool newVariable)
+    {
+        snarklib::R1Combination<FR> LC;
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            if (! x[i].zeroTerm() && FR::zero() != c[i])
+                appendLinear(LC, c[i], x[i]);
+        }
+
+        return sumTerm(LC, witness, newVariable);
+    }
+
 private:
+    R1T sumTerm(const snarklib::R1Combination<FR>& LC,
+                const FR& witness,
+                const bool newVariable)
+    {
+        bool isVar = false;
+        for (const auto& t : LC.terms()) {
+            if (t.isVariable())
+                isVar = true;
+        }
+
+        if (! isVar) return createConstant(witness);
+
+        if (1 == LC.terms().size()) return LC.terms()[0];
+
+        if (newVariable) {
+            const R1T z = createVariable(witness);
+            addConstraint(LC == z);
+            if (m_recordTape) m_tape.linear(z.index(), LC);
+            return z;
+        }
+
+        return linearTerm(LC, witness);
+    }
+
     template <typename ENUM>
     R1T imperative_GATE(const ENUM op,
                         const std::vector<R1T>& x,
@@ -622,27 +1448,325 @@ private:
         return createTerm(a, true);
     }
 
+    // z = OP(x, y) is new variable unless linear or same operation seen before
+    template <typename ENUM>
+    R1T createVariable(const ENUM op, const R1T& x, const R1T& y, const FR& witness) {
+        const int sign = m_linearMax ? linearSign(op) : 0;
+        if (0 != sign) {
+            // z = x + y, x - y, or 1 - x
+            const FR c = (sign > 0) ? FR::one() : FR::zero() - FR::one();
+
+            snarklib::R1Combination<FR> LC;
+            if (1 == opArgc(op)) {
+                LC.addTerm(R1T(FR::one()));
+                appendLinear(LC, c, x);
+
+            } else {
+                appendLinear(LC, FR::one(), x);
+                appendLinear(LC, c, y);
+            }
+
+            return linearTerm(LC, witness);
+        }
+
+        if (! m_cse) {
+            const R1T z = createVariable(witness);
+            addConstraint(op, x, y, z);
+            tapeOp(op, z, x, y);
+            return z;
+        }
+
+        // unary operators ignore y, commutative operators ignore order
+        const bool unary = (1 == opArgc(op));
+        const bool swapXY = ! unary && isCommutative(op) && (y.index() < x.index());
+        const R1T& a = swapXY ? y : x;
+        const R1T& b = unary ? x : (swapXY ? x : y);
+
+        const std::array<std::size_t, 4> key = {
+            cseClass(op), static_cast<std::size_t>(op), a.index(), b.index() };
+
+        const auto it = m_cseTable.find(key);
+        if (m_cseTable.end() != it) {
+            for (const auto& e : it->second) {
+                if (e.x == a.coeff() && e.y == b.coeff()) {
+                    ++m_cseSaved;
+                    return e.z;
+                }
+            }
+        }
+
+        const R1T z = createVariable(witness);
+        addConstraint(op, x, y, z);
+        tapeOp(op, z, x, y);
+
+        // no room left in the table
+        if (m_cseTableEntries < m_cseTableMax) {
+            if (m_cseTable.end() != it)
+                it->second.emplace_back(CSE_Entry{a.coeff(), b.coeff(), z});
+            else
+                m_cseTable[key].emplace_back(CSE_Entry{a.coeff(), b.coeff(), z});
+
+            ++m_cseTableEntries;
+        }
+
+        return z;
+    }
+
+    // z = OP(x, y, w) is one constraint for CH, two for MAJ and XOR3
+    // with the product p = x * y (shared like any other AND)
+    R1T createVariable(const BitwiseOps op,
+                       const std::array<R1T, 3>& x,
+                       const std::array<int, 3>& b,
+                       const FR& witness)
+    {
+        const R1T p = (BitwiseOps::CH == op)
+            ? R1T()
+            : createResult(BitwiseOps::AND, x[0], x[1], boolTo<FR>(b[0] && b[1]));
+
+        const R1T z = createVariable(witness);
+        addConstraint(op, x[0], x[1], x[2], p, z);
+
+        if (m_recordTape)
+            m_tape.op(op, z.index(), expandTerm(x[0]), expandTerm(x[1]), expandTerm(x[2]));
+
+        return z;
+    }
+
+    // bit operation result after simplification
+    template <typename ENUM>
+    R1T createBits(const ENUM op, const R1T& x, const R1T& y, const FR& witness) {
+        if (ENUM::CMPLMNT == op) {
+            // !!x == x
+            const auto it = m_complement.find(x.index());
+            if (m_complement.end() != it && FR::one() == x.coeff()) {
+                ++m_folded;
+                return it->second;
+            }
+
+            const R1T z = createVariable(op, x, y, witness);
+            m_complement.emplace(z.index(), x);
+            return z;
+        }
+
+        if (! x.isVariable() || ! y.isVariable()) {
+            // one argument is a constant bit
+            const R1T& c = x.isVariable() ? y : x;
+            const R1T& v = x.isVariable() ? x : y;
+
+            const bool isOne = (FR::one() == c.coeff());
+            if (isOne || FR::zero() == c.coeff()) {
+                // complement is free if linear, otherwise same cost as op
+                if ((ENUM::XOR == op && isOne) || (ENUM::SAME == op && ! isOne)) {
+                    if (m_linearMax) ++m_folded;
+                    return createBits(ENUM::CMPLMNT, v, v, witness);
+                }
+
+                ++m_folded;
+
+                switch (op) {
+                case (ENUM::AND) : return isOne ? v : R1T();          // x & 1 == x, x & 0 == 0
+                case (ENUM::OR) : return isOne ? R1T(FR::one()) : v; // x | 1 == 1, x | 0 == x
+                default : return v;                                   // x ^ 0 == x, (x == 1) == x
+                }
+            }
+
+        } else if (x.index() == y.index() && x.coeff() == y.coeff()) {
+            // same argument twice
+            ++m_folded;
+
+            switch (op) {
+            case (ENUM::XOR) : return R1T();            // x ^ x == 0
+            case (ENUM::SAME) : return R1T(FR::one());  // (x == x) == 1
+            default : return x;                         // x & x == x | x == x
+            }
+        }
+
+        return createVariable(op, x, y, witness);
+    }
+
+    // linear combination terms have the high bit set in their index
+    static std::size_t linearFlag() {
+        return std::size_t(1) << (8 * sizeof(std::size_t) - 1);
+    }
+
+    static std::size_t defaultLinearMax() {
+        return 256;
+    }
+
+    // about 40 MB of combinations for a 256-bit field
+    static std::size_t defaultLinearTableMax() {
+        return std::size_t(1) << 20;
+    }
+
+    // about 40 MB of results for a 256-bit field
+    static std::size_t defaultCSETableMax() {
+        return std::size_t(1) << 18;
+    }
+
+    bool isLinear(const R1T& x) const {
+        return x.index() & linearFlag();
+    }
+
+    // LC += c * x, where x may be a linear combination
+    void appendLinear(snarklib::R1Combination<FR>& LC, const FR& c, const R1T& x) const {
+        if (isLinear(x)) {
+            const FR k = c * x.coeff();
+            for (const auto& t : m_linear.at(x.index()).terms()) {
+                if (t.isVariable())
+                    LC.addTerm((k * t.coeff()) * t.var());
+                else
+                    LC.addTerm(R1T(k * t.coeff()));
+            }
+
+        } else if (x.isVariable()) {
+            LC.addTerm((c * x.coeff()) * x.var());
+
+        } else {
+            LC.addTerm(R1T(c * x.coeff()));
+        }
+    }
+
+    snarklib::R1Combination<FR> expandLinear(const snarklib::R1Combination<FR>& a) const {
+        snarklib::R1Combination<FR> LC;
+        LC.reserveTerms(a.terms().size());
+
+        for (const auto& t : a.terms()) {
+            if (isLinear(t))
+                appendLinear(LC, FR::one(), t);
+            else
+                LC.addTerm(t);
+        }
+
+        return LC;
+    }
+
+    // term standing for linear combination (or new variable if too long)
+    R1T linearTerm(const snarklib::R1Combination<FR>& LC, const FR& witness) {
+        // too long or no room left in the table
+        const std::size_t n = LC.terms().size();
+        if (n > m_linearMax || m_linearTableTerms + n > m_linearTableMax) {
+            const R1T z = createVariable(witness);
+            addConstraint(LC == z);
+            if (m_recordTape) m_tape.linear(z.index(), LC);
+            return z;
+        }
+
+        // unique across parallel shards as base IDs do not overlap
+        const std::size_t id = linearFlag() | (m_shardBase + ++m_linearCount);
+        m_linear.emplace(id, LC);
+        m_linearTableTerms += n;
+        return R1V(id);
+    }
+
+    template <typename ENUM>
+    void tapeOp(const ENUM op, const R1T& z, const R1T& x, const R1T& y) {
+        if (m_recordTape)
+            m_tape.op(op, z.index(), expandTerm(x), expandTerm(y));
+    }
+
+    // operator enumerations may have the same numeric values
+    static std::size_t cseClass(const LogicalOps) { return 0; }
+    static std::size_t cseClass(const ScalarOps) { return 1; }
+    static std::size_t cseClass(const FieldOps) { return 2; }
+    static std::size_t cseClass(const BitwiseOps) { return 3; }
+
+    void countConstraint(const snarklib::R1Constraint<FR>& c) {
+        m_profiler.countConstraint(c.a().terms().size() +
+                                   c.b().terms().size() +
+                                   c.c().terms().size());
+    }
+
+    void emitConstraint(const snarklib::R1Constraint<FR>& c) {
+#ifdef USE_ASSERT
+        // variables from merged shards were renumbered
+        for (const auto& LC : { &c.a(), &c.b(), &c.c() }) {
+            for (const auto& t : LC->terms())
+                assert(t.index() < m_retiredBegin || t.index() >= m_retiredEnd);
+        }
+#endif
+        countConstraint(c);
+        if (m_hashing) m_hash = rank1_hash(m_hash, c);
+
+        if (m_countOnly) {
+            ++m_countConstraints;
+            m_countTerms += c.a().terms().size() +
+                            c.b().terms().size() +
+                            c.c().terms().size();
+
+            const std::size_t bound = counterID();
+            m_countABC[0].touch(c.a(), m_shardBase, bound);
+            m_countABC[1].touch(c.b(), m_shardBase, bound);
+            m_countABC[2].touch(c.c(), m_shardBase, bound);
+            return;
+        }
+
+        // already in cached files
+        if (m_cached) return;
+
+        // shards are counted when appended, indices after the
+        // counter belong to shards not yet merged
+        if (0 == m_shardBase) touchAB(c, counterID());
+
+        m_constraintSystem.addConstraint(c);
+    }
+
+    // variables used by A and B, same statistic as
+    // HugeSystem::swap_AB_if_beneficial() without the extra pass before
+    // keypair() or proof()
+    void touchAB(const snarklib::R1Constraint<FR>& c, const std::size_t bound) {
+        touchVariables(c.a(), bound, m_touchedA, m_nonzeroA);
+        touchVariables(c.b(), bound, m_touchedB, m_nonzeroB);
+    }
+
+    static void touchVariables(const snarklib::R1Combination<FR>& a,
+                               const std::size_t bound,
+                               std::vector<bool>& touched,
+                               std::size_t& count)
+    {
+        for (const auto& t : a.terms()) {
+            const std::size_t i = t.index();
+            if (i >= bound) continue;
+
+            if (i >= touched.size())
+                touched.resize(std::max(i + 1, 2 * touched.size()), false);
+
+            if (! touched[i]) {
+                touched[i] = true;
+                ++count;
+            }
+        }
+    }
+
+    void clearAB() {
+        m_touchedA.clear();
+        m_touchedB.clear();
+        m_nonzeroA = 0;
+        m_nonzeroB = 0;
+    }
+
+    static std::string hashFile(const std::string& filePrefix) {
+        return filePrefix + ".hash";
+    }
+
     void setVariable(const R1T& x, const FR& value) {
-        m_constraintSystem.addConstraint(x == value);
+        addConstraint(x == value);
     }
 
     void addWitness(const R1V& x, const FR& value) {
-        m_witness_FR.assignVar(x, value);
+        if (m_countOnly) return;
+
+        // shard witness is relative to base ID (zero unless parallel)
+        m_witness_FR.assignVar(R1V(x.index() - m_shardBase), value);
     }
 
     void addWitness(const R1T& x, const FR& value) {
         addWitness(x.var(), value);
     }
 
-    void addWitness(const std::vector<R1T>& r1Terms, const std::string& value) {
-        m_witness_str.emplace_back(
-            std::pair<std::size_t, std::string>(
-                r1Terms.front().index(),
-                value));
-    }
-
     void addSplit(const R1T& x, const std::vector<R1T>& b) {
-        rank1_split(m_constraintSystem, x, b);
+        if (m_witnessOnly) return;
+        const ProfileOp prof(m_profiler, "split");
+        rank1_split(*this, x, b);
     }
 
     // z = OP(x, y)
@@ -653,23 +1777,23 @@ private:
 
         switch (op) {
         case (LogicalOps::AND) :
-            rank1_op<snarklib::HugeSystem, R1_AND<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_AND<FR>>(*this, x, y, z);
             break;
 
         case (LogicalOps::OR) :
-            rank1_op<snarklib::HugeSystem, R1_OR<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_OR<FR>>(*this, x, y, z);
             break;
 
         case (LogicalOps::XOR) :
-            rank1_op<snarklib::HugeSystem, R1_XOR<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_XOR<FR>>(*this, x, y, z);
             break;
 
         case (LogicalOps::SAME) :
-            rank1_op<snarklib::HugeSystem, R1_SAME<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_SAME<FR>>(*this, x, y, z);
             break;
 
         case (LogicalOps::CMPLMNT) :
-            rank1_op<snarklib::HugeSystem, R1_CMPLMNT<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_CMPLMNT<FR>>(*this, x, y, z);
             break;
         }
     }
@@ -682,15 +1806,15 @@ private:
 
         switch (op) {
         case (ScalarOps::ADD) :
-            rank1_op<snarklib::HugeSystem, R1_ADD<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_ADD<FR>>(*this, x, y, z);
             break;
 
         case (ScalarOps::SUB) :
-            rank1_op<snarklib::HugeSystem, R1_SUB<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_SUB<FR>>(*this, x, y, z);
             break;
 
         case (ScalarOps::MUL) :
-            rank1_op<snarklib::HugeSystem, R1_MUL<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_MUL<FR>>(*this, x, y, z);
             break;
         }
     }
@@ -703,19 +1827,19 @@ private:
 
         switch (op) {
         case (FieldOps::ADD) :
-            rank1_op<snarklib::HugeSystem, R1_ADD<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_ADD<FR>>(*this, x, y, z);
             break;
 
         case (FieldOps::SUB) :
-            rank1_op<snarklib::HugeSystem, R1_SUB<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_SUB<FR>>(*this, x, y, z);
             break;
 
         case (FieldOps::MUL) :
-            rank1_op<snarklib::HugeSystem, R1_MUL<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_MUL<FR>>(*this, x, y, z);
             break;
 
         case (FieldOps::INV) :
-            rank1_op<snarklib::HugeSystem, R1_INV<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_INV<FR>>(*this, x, y, z);
             break;
         }
     }
@@ -728,31 +1852,58 @@ private:
 
         switch (op) {
         case (BitwiseOps::AND) :
-            rank1_op<snarklib::HugeSystem, R1_AND<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_AND<FR>>(*this, x, y, z);
             break;
 
         case (BitwiseOps::OR) :
-            rank1_op<snarklib::HugeSystem, R1_OR<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_OR<FR>>(*this, x, y, z);
             break;
 
         case (BitwiseOps::XOR) :
-            rank1_op<snarklib::HugeSystem, R1_XOR<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_XOR<FR>>(*this, x, y, z);
             break;
 
         case (BitwiseOps::SAME) :
-            rank1_op<snarklib::HugeSystem, R1_SAME<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_SAME<FR>>(*this, x, y, z);
             break;
 
         case (BitwiseOps::CMPLMNT) :
-            rank1_op<snarklib::HugeSystem, R1_CMPLMNT<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_CMPLMNT<FR>>(*this, x, y, z);
             break;
 
         case (BitwiseOps::ADDMOD) :
-            rank1_op<snarklib::HugeSystem, R1_ADD<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_ADD<FR>>(*this, x, y, z);
             break;
 
         case (BitwiseOps::MULMOD) :
-            rank1_op<snarklib::HugeSystem, R1_MUL<FR>>(m_constraintSystem, x, y, z);
+            rank1_op<R1C, R1_MUL<FR>>(*this, x, y, z);
+            break;
+        }
+    }
+
+    // w = OP(x, y, z) with p = x * y
+    void addConstraint(const BitwiseOps op,
+                       const R1T& x,
+                       const R1T& y,
+                       const R1T& z,
+                       const R1T& p,
+                       const R1T& w)
+    {
+#ifdef USE_ASSERT
+        assert(w.isVariable() && isTernary(op));
+#endif
+
+        switch (op) {
+        case (BitwiseOps::CH) :
+            rank1_op<R1C, R1_CH<FR>>(*this, x, y, z, p, w);
+            break;
+
+        case (BitwiseOps::MAJ) :
+            rank1_op<R1C, R1_MAJ<FR>>(*this, x, y, z, p, w);
+            break;
+
+        case (BitwiseOps::XOR3) :
+            rank1_op<R1C, R1_XOR3<FR>>(*this, x, y, z, p, w);
             break;
         }
     }
@@ -794,24 +1945,157 @@ private:
     }
 
     // not optional, must do this before everything
+    // (decided by counts from addConstraint(), no scan to find out)
     void swap_AB_if_beneficial() {
         if (! m_swap_AB_if_beneficial) {
             m_swap_AB_if_beneficial = true;
 
-            m_constraintSystem.swap_AB_if_beneficial();
+            if (swapBeneficial())
+                m_constraintSystem.mapLambda(
+                    [] (snarklib::R1System<FR>& S) -> bool {
+                        for (auto& c : S.constraints())
+                            c = snarklib::R1Constraint<FR>(c.b(), c.a(), c.c());
+
+                        return true;
+                    });
         }
     }
 
     // variable indices
     Counter<std::size_t> m_counter;
+    std::size_t m_shardBase, m_retiredBegin, m_retiredEnd;
+
+    // common subexpressions, coefficients distinguish terms with same index
+    struct CSE_Entry { FR x, y; R1T z; };
+    struct CSE_Hash {
+        std::size_t operator() (const std::array<std::size_t, 4>& a) const {
+            std::uint64_t h = 0;
+            for (const auto& b : a) h = rank1_hash(h, b);
+            return h;
+        }
+    };
+    bool m_cse;
+    std::size_t m_cseSaved, m_cseTableMax, m_cseTableEntries;
+    std::unordered_map<std::array<std::size_t, 4>, std::vector<CSE_Entry>, CSE_Hash> m_cseTable;
+
+    // simplified bit operations, complement result index to argument
+    std::size_t m_folded;
+    std::unordered_map<std::size_t, R1T> m_complement;
+
+    // bit decompositions, scalar variable index to bits
+    struct Split_Entry { FR coeff; std::vector<R1T> bits; };
+    std::unordered_map<std::size_t, Split_Entry> m_splitCache;
+
+    // words summed by modulo addition, scalar term index to count
+    std::unordered_map<std::size_t, std::size_t> m_addends;
+
+    // linear combinations, indexed by term variable index
+    std::size_t m_linearMax, m_linearCount;
+    std::size_t m_linearTableMax, m_linearTableTerms;
+    std::unordered_map<std::size_t, snarklib::R1Combination<FR>> m_linear;
+
+    // constraint and variable accounting
+    Profiler m_profiler;
+
+    // cached constraint system files
+    std::string m_filePrefix;
+    bool m_hashing, m_cached;
+    std::uint64_t m_hash, m_cachedHash;
+
+    // variables used by a matrix in count only mode, those of this
+    // collector relative to base ID, others (calling thread or shards
+    // not yet merged) are listed and renumbered when merged
+    class Touched
+    {
+    public:
+        Touched()
+            : m_count(0)
+        {}
+
+        void touch(const snarklib::R1Combination<FR>& a,
+                   const std::size_t base,
+                   const std::size_t bound)
+        {
+            for (const auto& t : a.terms()) {
+                const std::size_t i = t.index();
+                if (i >= base && i < bound)
+                    set(i - base);
+                else
+                    m_other.push_back(i);
+            }
+        }
+
+        bool touched(const std::size_t i) const {
+            return i < m_own.size() && m_own[i];
+        }
+
+        // variables below bound, other variables must be merged first
+        std::size_t count(const std::size_t bound) const {
+            std::size_t n = m_count;
+            std::vector<bool> seen;
+            for (const auto i : m_other) {
+                if (i >= bound || touched(i)) continue;
+
+                if (i >= seen.size()) seen.resize(i + 1, false);
+                if (! seen[i]) {
+                    seen[i] = true;
+                    ++n;
+                }
+            }
+
+            return n;
+        }
+
+        // renumber variables of collector with base zero
+        template <typename FUNC>
+        void remap(FUNC func) {
+            Touched a;
+            a.append(*this, func, 0);
+            *this = std::move(a);
+        }
+
+        // variables of a shard with base ID
+        template <typename FUNC>
+        void append(const Touched& shard, FUNC func, const std::size_t base) {
+            for (std::size_t i = 0; i < shard.m_own.size(); ++i) {
+                if (shard.m_own[i]) set(func(base + i));
+            }
+
+            for (const auto i : shard.m_other)
+                set(func(i));
+        }
+
+    private:
+        void set(const std::size_t i) {
+            if (i >= m_own.size())
+                m_own.resize(std::max(i + 1, 2 * m_own.size()), false);
+
+            if (! m_own[i]) {
+                m_own[i] = true;
+                ++m_count;
+            }
+        }
 
-    // quadratic constraint system
+        std::vector<bool> m_own;
+        std::vector<std::size_t> m_other;
+        std::size_t m_count;
+    };
+
+    // quadratic constraint system, variables used by A and B
+    bool m_witnessOnly;
+    bool m_countOnly;
+    std::size_t m_countConstraints, m_countTerms, m_countInputs;
+    std::array<Touched, 3> m_countABC;
+    std::vector<bool> m_touchedA, m_touchedB;
+    std::size_t m_nonzeroA, m_nonzeroB;
     bool m_swap_AB_if_beneficial;
     snarklib::HugeSystem<FR> m_constraintSystem;
 
     // variable assignment witness
     snarklib::R1Witness<FR> m_witness_FR;
-    std::vector<std::pair<std::size_t, std::string>> m_witness_str;
+    std::vector<std::pair<std::size_t, WitnessValue>> m_witness_val;
+    bool m_recordTape;
+    WitnessTape<FR> m_tape;
 
     // input witness for (de)marshalling
     R1Cowitness<FR> m_input;
@@ -4,6 +4,8 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <ostream>
+#include <streambuf>
 #include <vector>
 
 #include <snarklib/Rank1DSL.hpp>
@@ -103,6 +105,32 @@ DEFN_R1OP(INV, x * z == FR::one())
 
 #undef DEFN_R1OP
 
+// three argument bit operators, w is the result and p = x * y is a
+// variable of its own (not used by CH)
+#define DEFN_R1OP3(NAME, XYZPW)                         \
+template <typename FR>                                  \
+class R1_ ## NAME                                       \
+{                                                       \
+public:                                                 \
+    typedef FR FieldType;                               \
+    static snarklib::R1Constraint<FR> constraint(       \
+        const snarklib::R1Term<FR>& x,                  \
+        const snarklib::R1Term<FR>& y,                  \
+        const snarklib::R1Term<FR>& z,                  \
+        const snarklib::R1Term<FR>& p,                  \
+        const snarklib::R1Term<FR>& w) {                \
+        return XYZPW ;                                  \
+    }                                                   \
+};
+
+// CH, MAJ, XOR3
+DEFN_R1OP3(CH, w - z == x * (y - z))
+DEFN_R1OP3(MAJ, w - p == z * (x + y - (FR::one() + FR::one()) * p))
+DEFN_R1OP3(XOR3, x + y - (FR::one() + FR::one()) * p + z - w ==
+                 ((FR::one() + FR::one()) * z) * (x + y - (FR::one() + FR::one()) * p))
+
+#undef DEFN_R1OP3
+
 ////////////////////////////////////////////////////////////////////////////////
 // function to apply operators
 //
@@ -117,6 +145,18 @@ void rank1_op(
     S.addConstraint(R1OP::constraint(x, y, z));
 }
 
+template <template <typename> class SYS, typename R1OP>
+void rank1_op(
+    SYS<typename R1OP::FieldType>& S,
+    const snarklib::R1Term<typename R1OP::FieldType>& x,
+    const snarklib::R1Term<typename R1OP::FieldType>& y,
+    const snarklib::R1Term<typename R1OP::FieldType>& z,
+    const snarklib::R1Term<typename R1OP::FieldType>& p,
+    const snarklib::R1Term<typename R1OP::FieldType>& w)
+{
+    S.addConstraint(R1OP::constraint(x, y, z, p, w));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // bit shift and rotate
 //
@@ -252,6 +292,118 @@ rank1_xword(
     return v;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// variable index relocation (merging constraint systems)
+//
+
+template <typename FR, typename FUNC>
+snarklib::R1Combination<FR> rank1_remap(const snarklib::R1Combination<FR>& LC,
+                                        FUNC func)
+{
+    snarklib::R1Combination<FR> v;
+    v.reserveTerms(LC.terms().size());
+
+    for (const auto& t : LC.terms()) {
+        if (t.isVariable())
+            v.addTerm(
+                t.coeff() * snarklib::R1Variable<FR>(func(t.index())));
+        else
+            v.addTerm(t); // constant term has index 0
+    }
+
+    return v;
+}
+
+template <typename FR, typename FUNC>
+snarklib::R1Constraint<FR> rank1_remap(const snarklib::R1Constraint<FR>& C,
+                                       FUNC func)
+{
+    return snarklib::R1Constraint<FR>(rank1_remap(C.a(), func),
+                                      rank1_remap(C.b(), func),
+                                      rank1_remap(C.c(), func));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// structural hash (same circuit, same constraint system)
+//
+
+inline std::uint64_t rank1_hash(std::uint64_t h, const std::uint64_t a)
+{
+    h = (h ^ a) * 0x9e3779b97f4a7c15ULL;
+    return h ^ (h >> 32);
+}
+
+// field elements are hashed in snarklib raw form (Montgomery limbs, no
+// conversion), folded in 8 bytes at a time as they are written out
+class RawHash : public std::streambuf
+{
+public:
+    RawHash()
+        : m_os(this),
+          m_h(0),
+          m_word(0),
+          m_count(0)
+    {}
+
+    template <typename FR>
+    std::uint64_t hash(const std::uint64_t h, const FR& a) {
+        m_h = h;
+        m_word = m_count = 0;
+
+        a.marshal_out_raw(m_os);
+        if (m_count) m_h = rank1_hash(m_h, m_word);
+
+        return m_h;
+    }
+
+protected:
+    int_type overflow(int_type c) {
+        if (! traits_type::eq_int_type(traits_type::eof(), c))
+            put(traits_type::to_char_type(c));
+
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) {
+        for (std::streamsize i = 0; i < n; ++i) put(s[i]);
+        return n;
+    }
+
+private:
+    void put(const char c) {
+        m_word |= std::uint64_t(static_cast<unsigned char>(c)) << (8 * m_count);
+
+        if (8 == ++m_count) {
+            m_h = rank1_hash(m_h, m_word);
+            m_word = m_count = 0;
+        }
+    }
+
+    std::ostream m_os;
+    std::uint64_t m_h, m_word, m_count;
+};
+
+template <typename FR>
+std::uint64_t rank1_hash(std::uint64_t h, const snarklib::R1Combination<FR>& LC)
+{
+    auto& RH = TL<RawHash>::singleton();
+
+    h = rank1_hash(h, LC.terms().size());
+
+    for (const auto& t : LC.terms()) {
+        h = rank1_hash(h, t.index());
+        h = RH->hash(h, t.coeff());
+    }
+
+    return h;
+}
+
+template <typename FR>
+std::uint64_t rank1_hash(std::uint64_t h, const snarklib::R1Constraint<FR>& C)
+{
+    return rank1_hash(rank1_hash(rank1_hash(h, C.a()), C.b()), C.c());
+}
+
 } // namespace snarkfront
 
 #endif
@@ -0,0 +1,194 @@
+#ifndef _SNARKFRONT_SUB_CIRCUIT_HPP_
+#define _SNARKFRONT_SUB_CIRCUIT_HPP_
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include <snarklib/Rank1DSL.hpp>
+
+#include <snarkfront/PowersOf2.hpp>
+#include <snarkfront/R1C.hpp>
+#include <snarkfront/Rank1Ops.hpp>
+#include <snarkfront/TLsingleton.hpp>
+#include <snarkfront/WitnessTape.hpp>
+#include <snarkfront/WitnessValue.hpp>
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// sub-circuit synthesized once, instantiated many times
+//
+// The function is evaluated once in its own collector. Its arguments are
+// formal inputs, variables 1 to N in local indices. The constraints and
+// witness tape over local indices are kept. Each instance copies them
+// with formal inputs bound to the bits of the arguments and the other
+// variables numbered after the calling collector's counter. The witness
+// comes from replaying the tape, no AST is evaluated.
+//
+// The circuit must be the same for any argument values and may only use
+// its arguments (no variables of the calling circuit). Arguments and
+// results are unsigned integer words or bool.
+//
+// Formal inputs are bits. An argument which is a scalar, e.g. the result
+// of modulo addition, is split when bound (booleanity for every bit and
+// one split constraint) even if the sub-circuit would only add it. Inline
+// DSL may not need the split. A chain of instances passing sums along
+// costs about one word of bits more per link than the same code inline.
+//
+// The calling collector is restored if capture throws. A variable from
+// outside the sub-circuit throws std::logic_error.
+//
+
+template <typename IN, typename OUT>
+class SubCircuit
+{
+public:
+    typedef typename IN::FrType FR;
+    typedef typename IN::R1T R1T;
+    typedef snarklib::R1Combination<FR> R1C_LC;
+
+    // local variable IDs are reserved after base while capturing
+    SubCircuit(const std::size_t numInputs,
+               const std::function<std::vector<OUT> (const std::vector<IN>&)>& func,
+               const std::size_t base = std::size_t(1) << 40)
+    {
+        auto& RS = *TL<R1C<FR>>::singleton();
+        R1C<FR> caller = std::move(RS);
+        const RestoreCaller restore(RS, caller);
+
+        RS.reserveIDs(base);
+        RS.copyOptions(caller);
+        RS.recordTape(true);
+
+        // arguments of each instance are constrained already
+        std::vector<IN> formal(numInputs);
+        RS.witnessOnly(true);
+        for (auto& x : formal)
+            x.bless(typename IN::ValueType(0));
+        RS.witnessOnly(false);
+
+        m_numFormal = RS.variableCount();
+
+        const std::vector<OUT> result = func(formal);
+
+        const auto local = [base] (const std::size_t i) -> std::size_t {
+            if (0 == i) return 0; // constant one
+
+            if (i <= base)
+                throw std::logic_error("SubCircuit: variable from outside the sub-circuit");
+
+            return i - base;
+        };
+
+        RS.forEachConstraint(
+            [this, &local] (const snarklib::R1Constraint<FR>& c) {
+                m_constraints.emplace_back(rank1_remap(c, local));
+            });
+
+        m_tape = RS.witnessTape();
+        m_tape.remap(local);
+
+        for (const auto& x : result) {
+            m_splitSize.push_back(x->splitBits().size());
+            m_numTerms.push_back(x->r1Terms().size());
+            for (const auto& t : x->r1Terms())
+                m_outputs.emplace_back(rank1_remap(RS.expandTerm(t), local));
+        }
+
+        m_numVariables = RS.variableCount();
+    }
+
+    std::size_t numberConstraints() const { return m_constraints.size(); }
+    std::size_t numberVariables() const { return m_numVariables; }
+
+    // instance of sub-circuit in calling collector
+    std::vector<OUT> operator() (const std::vector<IN>& args) const {
+        auto& RS = *TL<R1C<FR>>::singleton();
+
+        std::vector<R1T> argTerms;
+        std::vector<WitnessValue> argValues;
+        argTerms.reserve(m_numFormal);
+        argValues.reserve(args.size());
+
+        for (const auto& x : args) {
+            // scalar arguments are split, low bits only
+            const auto b = RS.argBits(*x);
+            typename IN::ValueType dummy;
+            argTerms.insert(argTerms.end(), b.begin(), b.begin() + sizeBits(dummy));
+            argValues.emplace_back(x->value());
+        }
+
+#ifdef USE_ASSERT
+        assert(m_numFormal == argTerms.size());
+#endif
+
+        std::vector<FR> w = m_tape.values(argValues);
+        w.resize(m_numVariables + 1, FR::zero());
+
+        const auto z = RS.appendSubCircuit(m_constraints, m_tape, m_outputs, argTerms, w);
+
+        std::vector<OUT> result(m_splitSize.size());
+        for (std::size_t k = 0, j = 0; k < result.size(); j += m_numTerms[k++]) {
+            const std::vector<R1T> terms(z.begin() + j, z.begin() + j + m_numTerms[k]);
+
+            // witness of scalar or bits
+            std::vector<FR> v;
+            for (std::size_t i = j; i < j + m_numTerms[k]; ++i) {
+                FR sum = FR::zero();
+                for (const auto& t : m_outputs[i].terms())
+                    sum = sum + t.coeff() * w[t.index()];
+                v.push_back(sum);
+            }
+
+            std::vector<int> bits;
+            if (1 == v.size() && 1 != m_splitSize[k]) {
+                bits = valueBits(v[0]);
+                bits.resize(m_splitSize[k]);
+            } else {
+                for (const auto& a : v)
+                    bits.push_back(FR::one() == a);
+            }
+
+            typename OUT::ValueType value;
+            bitsValue(value, bits);
+
+            const FR witness = (1 == v.size())
+                ? v[0]
+                : valueToField<FR>(value);
+
+            result[k].bless(value, witness, bits, terms);
+        }
+
+        return result;
+    }
+
+private:
+    // capture collector is replaced by the caller's on any exit
+    class RestoreCaller
+    {
+    public:
+        RestoreCaller(R1C<FR>& RS, R1C<FR>& caller)
+            : m_RS(RS), m_caller(caller)
+        {}
+
+        ~RestoreCaller() {
+            m_RS = std::move(m_caller);
+        }
+
+    private:
+        R1C<FR> &m_RS, &m_caller;
+    };
+
+    std::size_t m_numFormal, m_numVariables;
+    std::vector<snarklib::R1Constraint<FR>> m_constraints;
+    WitnessTape<FR> m_tape;
+    std::vector<R1C_LC> m_outputs;
+    std::vector<std::size_t> m_splitSize, m_numTerms;
+};
+
+} // namespace snarkfront
+
+#endif
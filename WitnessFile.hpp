@@ -0,0 +1,365 @@
+#ifndef _SNARKFRONT_WITNESS_FILE_HPP_
+#define _SNARKFRONT_WITNESS_FILE_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmp.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <snarklib/Rank1DSL.hpp>
+
+#include <snarkfront/PowersOf2.hpp>
+#include <snarkfront/TLsingleton.hpp>
+#include <snarkfront/WitnessValue.hpp>
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// binary witness file format
+//
+// version 2, everything is little-endian:
+//   8 bytes   magic "SNARKFWT"
+//   uint32    version
+//   uint32    bytes per field element
+//   uint64    number of field elements, n
+//   n         field elements in snarklib raw form (fixed width limbs)
+//   uint64    number of typed values, m
+//   m         index entries: uint64 variable index, offset, length
+//   bytes     typed values, offsets from start of this blob
+//
+// Variable index i is field element i - 1. Typed values are sparse,
+// only variables which have one are in the index (sorted by index).
+// Everything after the magic has a fixed position or is found by the
+// index, so the file is read in place with mmap.
+//
+// Typed values are unsigned integers in little-endian bytes, the
+// PowersOf256 form, so they convert to field elements by addition.
+// Field element limbs are swapped on big-endian hosts. Every size and
+// index entry is checked against the file, which may come from the
+// prover and is not trusted.
+//
+
+#define SNARKFRONT_WITNESS_MAGIC "SNARKFWT"
+#define SNARKFRONT_WITNESS_VERSION 2
+
+// little-endian integer of len bytes
+inline void writeLE(std::ostream& os, std::uint64_t a, const std::size_t len)
+{
+    for (std::size_t i = 0; i < len; ++i) {
+        os.put(static_cast<char>(a & 0xff));
+        a >>= 8;
+    }
+}
+
+inline std::uint64_t readLE(const char* ptr, const std::size_t len)
+{
+    std::uint64_t a = 0;
+    for (std::size_t i = len; i > 0; --i)
+        a = (a << 8) | static_cast<unsigned char>(ptr[i - 1]);
+
+    return a;
+}
+
+inline bool hostLittleEndian()
+{
+    const std::uint16_t a = 1;
+    return 1 == *reinterpret_cast<const unsigned char*>(&a);
+}
+
+// raw field element limbs between host and little-endian order
+inline void swapLimbs(char* ptr, const std::size_t len)
+{
+    if (hostLittleEndian()) return;
+
+    for (std::size_t i = 0; i + sizeof(mp_limb_t) <= len; i += sizeof(mp_limb_t)) {
+        for (std::size_t j = 0; j < sizeof(mp_limb_t) / 2; ++j)
+            std::swap(ptr[i + j], ptr[i + sizeof(mp_limb_t) - 1 - j]);
+    }
+}
+
+// number of bytes in a raw field element
+template <typename FR>
+std::size_t witnessElementBytes()
+{
+    static const std::size_t N = [] () {
+        std::stringstream ss;
+        FR::zero().marshal_out_raw(ss);
+        return ss.str().size();
+    }();
+
+    return N;
+}
+
+// write witness and typed values
+template <typename FR>
+void marshal_out_witness(
+    std::ostream& os,
+    const snarklib::R1Witness<FR>& a,
+    const std::vector<std::pair<std::size_t, WitnessValue>>& values
+        = std::vector<std::pair<std::size_t, WitnessValue>>())
+{
+    os.write(SNARKFRONT_WITNESS_MAGIC, 8);
+    writeLE(os, SNARKFRONT_WITNESS_VERSION, 4);
+    writeLE(os, witnessElementBytes<FR>(), 4);
+
+    writeLE(os, a.size(), 8);
+    if (hostLittleEndian()) {
+        for (std::size_t i = 1; i <= a.size(); ++i)
+            a[i].marshal_out_raw(os);
+
+    } else {
+        std::stringstream ss;
+        for (std::size_t i = 1; i <= a.size(); ++i) {
+            ss.str(std::string());
+            a[i].marshal_out_raw(ss);
+            std::string b = ss.str();
+            swapLimbs(&b[0], b.size());
+            os.write(b.data(), b.size());
+        }
+    }
+
+    std::vector<std::string> blob;
+    blob.reserve(values.size());
+    for (const auto& p : values)
+        blob.emplace_back(p.second.bytes());
+
+    writeLE(os, values.size(), 8);
+    std::uint64_t offset = 0;
+    for (std::size_t k = 0; k < values.size(); ++k) {
+        writeLE(os, values[k].first, 8);
+        writeLE(os, offset, 8);
+        writeLE(os, blob[k].size(), 8);
+        offset += blob[k].size();
+    }
+
+    for (const auto& b : blob)
+        os.write(b.data(), b.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// memory mapped witness file
+//
+
+template <typename FR>
+class WitnessFile
+{
+public:
+    WitnessFile(const std::string& filename)
+        : m_error(true),
+          m_binary(false),
+          m_fd(-1),
+          m_ptr(nullptr),
+          m_size(0),
+          m_numberElems(0),
+          m_numberValues(0),
+          m_elems(nullptr),
+          m_index(nullptr),
+          m_blob(nullptr),
+          m_is(&m_buf)
+    {
+        struct stat st;
+        m_fd = open(filename.c_str(), O_RDONLY);
+        if (-1 == m_fd || -1 == fstat(m_fd, &st)) return;
+
+        m_size = st.st_size;
+        if (m_size < 24) return;
+
+        void *ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (MAP_FAILED == ptr) return;
+        m_ptr = static_cast<const char*>(ptr);
+
+        // text format if no magic
+        if (std::memcmp(m_ptr, SNARKFRONT_WITNESS_MAGIC, 8)) return;
+        m_binary = true;
+
+        if (SNARKFRONT_WITNESS_VERSION != readLE(m_ptr + 8, 4) ||
+            witnessElementBytes<FR>() != readLE(m_ptr + 12, 4))
+            return;
+
+        // field elements and value count must fit in the file
+        const std::uint64_t numberElems = readLE(m_ptr + 16, 8);
+        if (numberElems > (m_size - 24) / witnessElementBytes<FR>()) return;
+
+        const std::size_t valuePos = 24 + numberElems * witnessElementBytes<FR>();
+        if (m_size - valuePos < 8) return;
+
+        // index entries must fit in the file
+        const std::uint64_t numberValues = readLE(m_ptr + valuePos, 8);
+        if (numberValues > (m_size - valuePos - 8) / 24) return;
+
+        m_numberElems = numberElems;
+        m_numberValues = numberValues;
+        m_elems = m_ptr + 24;
+        m_index = m_ptr + valuePos + 8;
+        m_blob = m_index + 24 * m_numberValues;
+
+        // every typed value must be inside the blob, variable indices
+        // are increasing and have field elements
+        const std::size_t blobSize = m_size - (m_blob - m_ptr);
+        std::size_t prevIndex = 0;
+        for (std::size_t k = 0; k < m_numberValues; ++k) {
+            const std::uint64_t
+                idx = valueIndex(k),
+                offset = valueOffset(k),
+                length = valueLength(k);
+
+            if (idx <= prevIndex || idx > m_numberElems ||
+                offset > blobSize || length > blobSize - offset ||
+                length > WitnessValue::WORDS * 8) {
+                m_numberElems = m_numberValues = 0;
+                return;
+            }
+
+            prevIndex = idx;
+        }
+
+        m_error = false;
+    }
+
+    ~WitnessFile() {
+        if (m_ptr) munmap(const_cast<char*>(m_ptr), m_size);
+        if (-1 != m_fd) close(m_fd);
+    }
+
+    WitnessFile(const WitnessFile&) = delete;
+    WitnessFile& operator= (const WitnessFile&) = delete;
+
+    bool operator! () const { return m_error; }
+
+    // false for text format files
+    bool isBinary() const { return m_binary; }
+
+    std::size_t numberElems() const { return m_numberElems; }
+    std::size_t numberValues() const { return m_numberValues; }
+
+    // variable index starts at one (not thread safe, shares the stream)
+    FR element(const std::size_t varIndex) const {
+        FR a = FR::zero();
+        if (m_error || 0 == varIndex || varIndex > m_numberElems)
+            return a;
+
+        readElems(varIndex - 1, 1);
+        a.marshal_in_raw(m_is);
+        return a;
+    }
+
+    bool loadWitness(snarklib::R1Witness<FR>& a) const {
+        if (m_error) return false;
+
+        // little-endian hosts read the whole mapping in place
+        const bool inPlace = hostLittleEndian();
+        if (inPlace) readElems(0, m_numberElems);
+
+        a.clear();
+        for (std::size_t i = 1; i <= m_numberElems; ++i) {
+            if (! inPlace) readElems(i - 1, 1);
+
+            FR b;
+            if (! b.marshal_in_raw(m_is)) return false;
+            a.assignVar(snarklib::R1Variable<FR>(i), b);
+        }
+
+        return true;
+    }
+
+    // typed values in index order
+    std::size_t valueIndex(const std::size_t k) const {
+        if (k >= m_numberValues) return 0;
+        return readLE(m_index + 24 * k, 8);
+    }
+
+    WitnessValue value(const std::size_t k) const {
+        WitnessValue a;
+        if (! m_error && k < m_numberValues)
+            a.bytes(m_blob + valueOffset(k), valueLength(k));
+
+        return a;
+    }
+
+    // typed value as field element, bytes are looked up and added
+    FR valueElement(const std::size_t k) const {
+        FR a = FR::zero();
+        if (m_error || k >= m_numberValues) return a;
+
+        const char *ptr = m_blob + valueOffset(k);
+        for (std::size_t i = 0; i < valueLength(k); ++i) {
+            const std::uint8_t b = ptr[i];
+            if (b) a = a + TL<PowersOf256<FR>>::singleton()->lookUp(i, b);
+        }
+
+        return a;
+    }
+
+private:
+    class MemoryBuf : public std::streambuf
+    {
+    public:
+        void reset(const char* ptr, const std::size_t len) {
+            char *p = const_cast<char*>(ptr);
+            setg(p, p, p + len);
+        }
+    };
+
+    // point the stream at count field elements starting at element pos,
+    // big-endian hosts read a swapped copy
+    void readElems(const std::size_t pos, const std::size_t count) const {
+        const std::size_t len = count * witnessElementBytes<FR>();
+        const char *ptr = m_elems + pos * witnessElementBytes<FR>();
+
+        if (hostLittleEndian()) {
+            m_buf.reset(ptr, len);
+        } else {
+            m_swap.assign(ptr, ptr + len);
+            swapLimbs(m_swap.data(), len);
+            m_buf.reset(m_swap.data(), len);
+        }
+
+        m_is.clear();
+    }
+
+    std::size_t valueOffset(const std::size_t k) const {
+        return readLE(m_index + 24 * k + 8, 8);
+    }
+
+    std::size_t valueLength(const std::size_t k) const {
+        return readLE(m_index + 24 * k + 16, 8);
+    }
+
+    bool m_error, m_binary;
+    int m_fd;
+    const char *m_ptr;
+    std::size_t m_size, m_numberElems, m_numberValues;
+    const char *m_elems, *m_index, *m_blob;
+
+    // one stream reads every element
+    mutable MemoryBuf m_buf;
+    mutable std::istream m_is;
+    mutable std::vector<char> m_swap;
+};
+
+// read witness file in either binary or text format
+template <typename FR>
+bool marshal_in_witness(snarklib::R1Witness<FR>& a, const std::string& filename)
+{
+    const WitnessFile<FR> wf(filename);
+    if (wf.isBinary()) return wf.loadWitness(a);
+
+    std::ifstream ifs(filename);
+    return !!ifs && a.marshal_in(ifs);
+}
+
+} // namespace snarkfront
+
+#endif
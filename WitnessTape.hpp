@@ -0,0 +1,468 @@
+#ifndef _SNARKFRONT_WITNESS_TAPE_HPP_
+#define _SNARKFRONT_WITNESS_TAPE_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include <snarklib/Rank1DSL.hpp>
+
+#include <snarkfront/EnumOps.hpp>
+#include <snarkfront/WitnessValue.hpp>
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// witness generation recorded as a tape of operations
+//
+// Each new variable is written down with the operation that made it and
+// its arguments as linear combinations of earlier variables. For a fixed
+// circuit (same constraints for any input values), replay() makes the
+// whole witness from new inputs without the AST, Alg objects or any
+// constraints. Inputs are typed values in the order they were blessed
+// (calling thread first, then parallel shards in order).
+//
+// Values asserted by the circuit (e.g. assert_true) are recorded as
+// constants. New inputs must satisfy the same assertions.
+//
+
+template <typename FR>
+class WitnessTape
+{
+public:
+    typedef snarklib::R1Combination<FR> R1C_LC;
+
+    enum class Code : std::uint8_t {
+        INPUT,   // count bits of input arg
+        SPLIT,   // count bits of x
+        LINEAR,  // x
+        AND, OR, XOR, SAME, CMPLMNT,
+        ADD, SUB, MUL, INV,
+        CH, MAJ, XOR3 };
+
+    WitnessTape()
+        : m_maxIndex(0),
+          m_numInputs(0)
+    {}
+
+    void clear() {
+        m_code.clear();
+        m_index.clear();
+        m_coeff.clear();
+        m_unit.clear();
+        m_inputs.clear();
+        m_maxIndex = 0;
+        m_numInputs = 0;
+    }
+
+    bool empty() const { return m_code.empty(); }
+    std::size_t size() const { return m_code.size(); }
+    std::size_t maxIndex() const { return m_maxIndex; }
+
+    // typed input values as recorded, in blessing order
+    const std::vector<WitnessValue>& inputs() const { return m_inputs; }
+
+    // bits of a circuit input (variables z to z + n - 1)
+    void input(const std::size_t z, const std::size_t n, const WitnessValue& a) {
+        push(Code::INPUT, z, n, m_numInputs++, R1C_LC(), R1C_LC(), R1C_LC());
+        m_inputs.push_back(a);
+    }
+
+    // bits of a scalar (variables z to z + n - 1)
+    void split(const std::size_t z, const std::size_t n, const R1C_LC& x) {
+        push(Code::SPLIT, z, n, 0, x, R1C_LC(), R1C_LC());
+    }
+
+    // linear combination or constant
+    void linear(const std::size_t z, const R1C_LC& x) {
+        push(Code::LINEAR, z, 1, 0, x, R1C_LC(), R1C_LC());
+    }
+
+    // z = OP(x, y)
+    template <typename ENUM>
+    void op(const ENUM op, const std::size_t z, const R1C_LC& x, const R1C_LC& y) {
+        push(opCode(op), z, 1, 0, x, y, R1C_LC());
+    }
+
+    // z = OP(x, y, u) for CH, MAJ, XOR3
+    void op(const BitwiseOps op,
+            const std::size_t z,
+            const R1C_LC& x,
+            const R1C_LC& y,
+            const R1C_LC& u)
+    {
+        push(opCode(op), z, 1, 0, x, y, u);
+    }
+
+    // relocate variable indices
+    template <typename FUNC>
+    void remap(FUNC func) {
+        m_maxIndex = 0;
+        for (auto& a : m_code) {
+            a.z = func(a.z);
+            m_maxIndex = std::max(m_maxIndex, a.z + a.count - 1);
+        }
+
+        for (auto& i : m_index) i = func(i);
+    }
+
+    // tape of a parallel shard, relocating indices
+    template <typename FUNC>
+    void append(const WitnessTape& shard, FUNC func) {
+        const std::size_t base = m_index.size();
+        for (const auto& a : shard.m_code) {
+            Instr b = a;
+            b.z = func(a.z);
+            b.terms = base + a.terms;
+            if (Code::INPUT == a.code) b.arg += m_numInputs;
+            m_code.push_back(b);
+            m_maxIndex = std::max(m_maxIndex, b.z + b.count - 1);
+        }
+
+        for (const auto i : shard.m_index) m_index.push_back(func(i));
+        m_coeff.insert(m_coeff.end(), shard.m_coeff.begin(), shard.m_coeff.end());
+        m_unit.insert(m_unit.end(), shard.m_unit.begin(), shard.m_unit.end());
+
+        m_inputs.insert(m_inputs.end(), shard.m_inputs.begin(), shard.m_inputs.end());
+        m_numInputs += shard.m_numInputs;
+
+        order();
+    }
+
+    // tape of a sub-circuit over local indices, inputs are variables 1
+    // to N bound by func, other variables are offset
+    template <typename FUNC>
+    void instance(const WitnessTape& sub,
+                  const std::size_t N,
+                  const std::size_t offset,
+                  FUNC func)
+    {
+        for (const auto& a : sub.m_code) {
+            if (Code::INPUT == a.code) continue;
+#ifdef USE_ASSERT
+            assert(a.z > N);
+#endif
+            push(a.code, offset + a.z, a.count, a.arg,
+                 func(sub.combination(a.terms, a.nx)),
+                 func(sub.combination(a.terms + a.nx, a.ny)),
+                 func(sub.combination(a.terms + a.nx + a.ny, a.nu)));
+        }
+    }
+
+    // witness from new inputs
+    snarklib::R1Witness<FR> replay(const std::vector<WitnessValue>& inputs) const {
+        const std::vector<FR> w = values(inputs);
+
+        snarklib::R1Witness<FR> witness;
+        for (std::size_t i = 1; i <= m_maxIndex; ++i)
+            witness.assignVar(snarklib::R1Variable<FR>(i), w[i]);
+
+        return witness;
+    }
+
+    // variable values from new inputs, index zero is one
+    std::vector<FR> values(const std::vector<WitnessValue>& inputs) const {
+#ifdef USE_ASSERT
+        assert(inputs.size() == m_numInputs);
+#endif
+        const FR
+            zero = FR::zero(),
+            one = FR::one(),
+            two = one + one;
+
+        std::vector<FR> w(m_maxIndex + 1, zero);
+        w[0] = one;
+
+        for (const auto& a : m_code) {
+            const FR
+                x = eval(w, a.terms, a.nx),
+                y = eval(w, a.terms + a.nx, a.ny),
+                u = eval(w, a.terms + a.nx + a.ny, a.nu);
+
+            FR& z = w[a.z];
+
+            switch (a.code) {
+            case (Code::INPUT) : {
+                    const auto& v = inputs[a.arg];
+                    for (std::size_t i = 0; i < a.count; ++i)
+                        w[a.z + i] = ((v.word(i / 64) >> (i % 64)) & 0x1) ? one : zero;
+                }
+                break;
+
+            case (Code::SPLIT) : {
+                    const auto b = x[0].asBigInt();
+                    for (std::size_t i = 0; i < a.count; ++i)
+                        w[a.z + i] = b.testBit(i) ? one : zero;
+                }
+                break;
+
+            case (Code::LINEAR) : z = x; break;
+            case (Code::AND) : z = x * y; break;
+            case (Code::OR) : z = x + y - x * y; break;
+            case (Code::XOR) : z = x + y - two * x * y; break;
+            case (Code::SAME) : z = one - x - y + two * x * y; break;
+            case (Code::CMPLMNT) : z = one - x; break;
+            case (Code::ADD) : z = x + y; break;
+            case (Code::SUB) : z = x - y; break;
+            case (Code::MUL) : z = x * y; break;
+            case (Code::INV) : z = (zero == x) ? zero : inverse(x); break;
+            case (Code::CH) : z = u + x * (y - u); break;
+            case (Code::MAJ) : z = x * y + u * (x + y - two * x * y); break;
+            case (Code::XOR3) : {
+                    const FR t = x + y - two * x * y;
+                    z = t + u - two * t * u;
+                }
+                break;
+            }
+        }
+
+        return w;
+    }
+
+    void marshal_out(std::ostream& os) const {
+        os << m_code.size() << ' '
+           << m_numInputs << std::endl;
+
+        // instructions with their argument terms
+        for (const auto& a : m_code) {
+            os << static_cast<unsigned int>(a.code) << ' '
+               << a.z << ' '
+               << a.count << ' '
+               << a.arg << ' '
+               << a.nx << ' '
+               << a.ny << ' '
+               << a.nu << ' ';
+
+            for (std::size_t i = a.terms; i < a.terms + a.nx + a.ny + a.nu; ++i) {
+                os << m_index[i] << ' ';
+                m_coeff[i].marshal_out(os);
+            }
+
+            os << std::endl;
+        }
+    }
+
+    bool marshal_in(std::istream& is) {
+        clear();
+
+        std::size_t numberCode;
+        if (! (is >> numberCode >> m_numInputs)) return false;
+
+        m_code.reserve(numberCode);
+        for (std::size_t k = 0; k < numberCode; ++k) {
+            unsigned int code;
+            Instr a;
+            if (! (is >> code >> a.z >> a.count >> a.arg >> a.nx >> a.ny >> a.nu))
+                return false;
+
+            a.code = static_cast<Code>(code);
+            a.terms = m_index.size();
+            m_maxIndex = std::max(m_maxIndex, a.z + a.count - 1);
+            m_code.push_back(a);
+
+            for (std::size_t i = 0; i < a.nx + a.ny + a.nu; ++i) {
+                std::size_t idx;
+                FR c;
+                if (! (is >> idx) || ! c.marshal_in(is)) return false;
+
+                m_index.push_back(idx);
+                m_coeff.push_back(c);
+                m_unit.push_back(FR::one() == c);
+            }
+        }
+
+        return true;
+    }
+
+private:
+    struct Instr {
+        Code code;
+        std::size_t z, count, arg, terms, nx, ny, nu;
+    };
+
+    static Code opCode(const LogicalOps op) {
+        switch (op) {
+        case (LogicalOps::AND) : return Code::AND;
+        case (LogicalOps::OR) : return Code::OR;
+        case (LogicalOps::XOR) : return Code::XOR;
+        case (LogicalOps::SAME) : return Code::SAME;
+        case (LogicalOps::CMPLMNT) : return Code::CMPLMNT;
+        }
+    }
+
+    static Code opCode(const ScalarOps op) {
+        switch (op) {
+        case (ScalarOps::ADD) : return Code::ADD;
+        case (ScalarOps::SUB) : return Code::SUB;
+        case (ScalarOps::MUL) : return Code::MUL;
+        }
+    }
+
+    static Code opCode(const FieldOps op) {
+        switch (op) {
+        case (FieldOps::ADD) : return Code::ADD;
+        case (FieldOps::SUB) : return Code::SUB;
+        case (FieldOps::MUL) : return Code::MUL;
+        case (FieldOps::INV) : return Code::INV;
+        }
+    }
+
+    static Code opCode(const BitwiseOps op) {
+        switch (op) {
+        case (BitwiseOps::AND) : return Code::AND;
+        case (BitwiseOps::OR) : return Code::OR;
+        case (BitwiseOps::XOR) : return Code::XOR;
+        case (BitwiseOps::SAME) : return Code::SAME;
+        case (BitwiseOps::CMPLMNT) : return Code::CMPLMNT;
+        case (BitwiseOps::ADDMOD) : return Code::ADD;
+        case (BitwiseOps::MULMOD) : return Code::MUL;
+        case (BitwiseOps::CH) : return Code::CH;
+        case (BitwiseOps::MAJ) : return Code::MAJ;
+        case (BitwiseOps::XOR3) : return Code::XOR3;
+        default :
+            // shift and rotate do not make variables
+#ifdef USE_ASSERT
+            assert(! isPermute(op));
+#endif
+            return Code::LINEAR;
+        }
+    }
+
+    void push(const Code code,
+              const std::size_t z,
+              const std::size_t count,
+              const std::size_t arg,
+              const R1C_LC& x,
+              const R1C_LC& y,
+              const R1C_LC& u)
+    {
+        m_code.emplace_back(
+            Instr{code, z, count, arg, m_index.size(),
+                  x.terms().size(), y.terms().size(), u.terms().size()});
+
+        for (const auto LC : { &x, &y, &u }) {
+            for (const auto& t : LC->terms()) {
+                m_index.push_back(t.index());
+                m_coeff.push_back(t.coeff());
+                m_unit.push_back(FR::one() == t.coeff());
+            }
+        }
+
+        m_maxIndex = std::max(m_maxIndex, z + count - 1);
+    }
+
+    R1C_LC combination(const std::size_t first, const std::size_t n) const {
+        R1C_LC LC;
+        LC.reserveTerms(n);
+        for (std::size_t i = first; i < first + n; ++i) {
+            if (m_index[i])
+                LC.addTerm(m_coeff[i] * snarklib::R1Variable<FR>(m_index[i]));
+            else
+                LC.addTerm(snarklib::R1Term<FR>(m_coeff[i]));
+        }
+
+        return LC;
+    }
+
+    FR eval(const std::vector<FR>& w, const std::size_t first, const std::size_t n) const {
+        FR sum = FR::zero();
+        for (std::size_t i = first; i < first + n; ++i) {
+            sum = sum + (m_unit[i]
+                         ? w[m_index[i]]
+                         : m_coeff[i] * w[m_index[i]]);
+        }
+
+        return sum;
+    }
+
+    // instructions after their arguments (shards run concurrently with
+    // the calling thread, which may use their results)
+    void order() {
+        const std::size_t N = std::max(
+            m_maxIndex,
+            m_index.empty() ? 0 : *std::max_element(m_index.begin(), m_index.end()));
+
+        std::vector<bool> known(N + 1, false);
+        known[0] = true;
+
+        // instructions waiting on a variable
+        std::unordered_map<std::size_t, std::vector<std::size_t>> waiting;
+        std::vector<std::size_t> missing(m_code.size(), 0);
+
+        std::vector<Instr> code;
+        code.reserve(m_code.size());
+
+        std::vector<std::size_t> ready;
+        const auto release = [&] (const std::size_t k) {
+            ready.push_back(k);
+            while (! ready.empty()) {
+                const auto& a = m_code[ready.back()];
+                ready.pop_back();
+                code.push_back(a);
+
+                for (std::size_t i = a.z; i < a.z + a.count; ++i) {
+                    known[i] = true;
+
+                    const auto it = waiting.find(i);
+                    if (waiting.end() == it) continue;
+
+                    for (const auto j : it->second) {
+                        if (0 == --missing[j]) ready.push_back(j);
+                    }
+
+                    waiting.erase(it);
+                }
+            }
+        };
+
+        for (std::size_t k = 0; k < m_code.size(); ++k) {
+            const auto& a = m_code[k];
+            for (std::size_t i = a.terms; i < a.terms + a.nx + a.ny + a.nu; ++i) {
+                const std::size_t idx = m_index[i];
+                if (! known[idx]) {
+                    auto& v = waiting[idx];
+                    if (v.empty() || k != v.back()) {
+                        v.push_back(k);
+                        ++missing[k];
+                    }
+                }
+            }
+
+            if (0 == missing[k]) release(k);
+        }
+
+        // arguments never made (should not happen), keep tape order
+        for (std::size_t k = 0; k < m_code.size(); ++k) {
+            if (0 != missing[k]) code.push_back(m_code[k]);
+        }
+
+        m_code.swap(code);
+    }
+
+    std::vector<Instr> m_code;
+    std::vector<std::size_t> m_index;
+    std::vector<FR> m_coeff;
+    std::vector<std::uint8_t> m_unit;
+    std::vector<WitnessValue> m_inputs;
+    std::size_t m_maxIndex, m_numInputs;
+};
+
+template <typename FR>
+std::ostream& operator<< (std::ostream& os, const WitnessTape<FR>& a) {
+    a.marshal_out(os);
+    return os;
+}
+
+template <typename FR>
+std::istream& operator>> (std::istream& is, WitnessTape<FR>& a) {
+    if (! a.marshal_in(is)) a.clear();
+    return is;
+}
+
+} // namespace snarkfront
+
+#endif
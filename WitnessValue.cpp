@@ -0,0 +1,101 @@
+#include <gmp.h>
+
+#include "snarkfront/WitnessValue.hpp"
+
+using namespace std;
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// typed value of a circuit input
+//
+
+WitnessValue::WitnessValue()
+    : m_size(0)
+{
+    m_words.fill(0);
+}
+
+WitnessValue::WitnessValue(const bool a)
+    : WitnessValue{static_cast<uint64_t>(a)}
+{}
+
+WitnessValue::WitnessValue(const uint8_t a)
+    : WitnessValue{static_cast<uint64_t>(a)}
+{}
+
+WitnessValue::WitnessValue(const uint32_t a)
+    : WitnessValue{static_cast<uint64_t>(a)}
+{}
+
+WitnessValue::WitnessValue(const uint64_t a)
+    : WitnessValue{}
+{
+    m_words[0] = a;
+    m_size = 1;
+}
+
+string WitnessValue::str() const {
+    if (empty()) return "*";
+
+    mpz_t z;
+    mpz_init(z);
+    mpz_import(z, m_size, -1, sizeof(uint64_t), 0, 0, m_words.data());
+
+    string s(mpz_sizeinbase(z, 10) + 1, '\0');
+    mpz_get_str(&s[0], 10, z);
+    mpz_clear(z);
+
+    s.resize(s.find('\0'));
+    return s;
+}
+
+bool WitnessValue::str(const string& a) {
+    *this = WitnessValue();
+    if ("*" == a) return true;
+
+    mpz_t z;
+    mpz_init(z);
+    const bool ok = (0 == mpz_set_str(z, a.c_str(), 10))
+        && mpz_sgn(z) >= 0
+        && mpz_sizeinbase(z, 2) <= WORDS * 64;
+
+    if (ok) {
+        size_t count = 0;
+        mpz_export(m_words.data(), &count, -1, sizeof(uint64_t), 0, 0, z);
+        m_size = count ? count : 1;
+    }
+
+    mpz_clear(z);
+    return ok;
+}
+
+string WitnessValue::bytes() const {
+    string s;
+    if (empty()) return s;
+
+    for (size_t i = 0; i < m_size; ++i) {
+        for (size_t j = 0; j < 8; ++j)
+            s.push_back(static_cast<char>(m_words[i] >> (8 * j)));
+    }
+
+    // zero is one byte
+    while (s.size() > 1 && '\0' == s.back())
+        s.pop_back();
+
+    return s;
+}
+
+bool WitnessValue::bytes(const char* ptr, const size_t len) {
+    *this = WitnessValue();
+    if (0 == len) return true;
+    if (len > WORDS * 8) return false;
+
+    for (size_t i = 0; i < len; ++i)
+        m_words[i / 8] |= uint64_t(static_cast<unsigned char>(ptr[i])) << (8 * (i % 8));
+
+    m_size = (len + 7) / 8;
+    return true;
+}
+
+} // namespace snarkfront
@@ -0,0 +1,142 @@
+#ifndef _SNARKFRONT_WITNESS_VALUE_HPP_
+#define _SNARKFRONT_WITNESS_VALUE_HPP_
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <gmp.h>
+#include <string>
+
+#include <snarklib/BigInt.hpp>
+#include <snarklib/Field.hpp>
+
+#include <snarkfront/PowersOf2.hpp>
+#include <snarkfront/TLsingleton.hpp>
+
+namespace snarkfront {
+
+////////////////////////////////////////////////////////////////////////////////
+// typed value of a circuit input
+//
+// Unsigned integer in little-endian 64-bit words, wide enough for the
+// scalar field. Values stay binary in memory and are only formatted as
+// decimal text when written to or read from files.
+//
+
+class WitnessValue
+{
+public:
+    static const std::size_t WORDS = 4;
+
+    // no value, "*" in files
+    WitnessValue();
+
+    WitnessValue(const bool a);
+    WitnessValue(const std::uint8_t a);
+    WitnessValue(const std::uint32_t a);
+    WitnessValue(const std::uint64_t a);
+
+    template <mp_size_t N>
+    WitnessValue(const snarklib::BigInt<N>& a)
+        : WitnessValue{}
+    {
+#ifdef USE_ASSERT
+        assert(N <= WORDS && sizeof(mp_limb_t) == sizeof(std::uint64_t));
+#endif
+        for (mp_size_t i = 0; i < N; ++i)
+            m_words[i] = a.data()[i];
+
+        m_size = N;
+    }
+
+    template <typename T, std::size_t N>
+    WitnessValue(const snarklib::Field<T, N>& a)
+        : WitnessValue{a[0].asBigInt()}
+    {
+#ifdef USE_ASSERT
+        assert(1 == a.dimension()); // always true for elliptic curve
+                                    // scalar field
+#endif
+    }
+
+    bool empty() const {
+        return 0 == m_size;
+    }
+
+    std::uint64_t word(const std::size_t i) const {
+        return m_words[i];
+    }
+
+    void get(bool& a) const { a = m_words[0]; }
+    void get(std::uint8_t& a) const { a = m_words[0]; }
+    void get(std::uint32_t& a) const { a = m_words[0]; }
+    void get(std::uint64_t& a) const { a = m_words[0]; }
+
+    template <mp_size_t N>
+    void get(snarklib::BigInt<N>& a) const {
+        a = snarklib::BigInt<N>::zero();
+        for (mp_size_t i = 0; i < N && i < mp_size_t(WORDS); ++i)
+            a.data()[i] = m_words[i];
+    }
+
+    template <typename T, std::size_t N>
+    void get(snarklib::Field<T, N>& a) const {
+        a = TL<PowersOf256<snarklib::Field<T, N>>>::singleton()
+            ->getNumber(m_words.data(), m_size);
+    }
+
+    // decimal text
+    std::string str() const;
+    bool str(const std::string& a);
+
+    // little-endian bytes without leading zeros, empty if no value
+    std::string bytes() const;
+    bool bytes(const char* ptr, const std::size_t len);
+
+private:
+    std::array<std::uint64_t, WORDS> m_words;
+    std::size_t m_size;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// convert values to field elements
+//
+
+template <typename FR>
+FR valueToField(const bool a) {
+    return boolTo<FR>(a);
+}
+
+template <typename FR>
+FR valueToField(const std::uint8_t a) {
+    return TL<PowersOf256<FR>>::singleton()->getNumber(a);
+}
+
+template <typename FR>
+FR valueToField(const std::uint32_t a) {
+    return TL<PowersOf256<FR>>::singleton()->getNumber(a);
+}
+
+template <typename FR>
+FR valueToField(const std::uint64_t a) {
+    return TL<PowersOf256<FR>>::singleton()->getNumber(a);
+}
+
+template <typename FR, mp_size_t N>
+FR valueToField(const snarklib::BigInt<N>& a) {
+#ifdef USE_ASSERT
+    assert(sizeof(mp_limb_t) == sizeof(std::uint64_t));
+#endif
+    return TL<PowersOf256<FR>>::singleton()->getNumber(
+        reinterpret_cast<const std::uint64_t*>(a.data()),
+        N);
+}
+
+template <typename FR>
+FR valueToField(const FR& a) {
+    return a;
+}
+
+} // namespace snarkfront
+
+#endif
@@ -298,12 +298,6 @@ void generate_proof(const string& proof,
     witnessVal(ppzk_K, ofs);
 }
 
-template <typename T>
-bool marshal_in(T& obj, const string& filename) {
-    ifstream ifs(filename);
-    return !!ifs && obj.marshal_in(ifs);
-}
-
 template <typename T>
 bool marshal_in_raw(T& obj, const string& filename) {
     ifstream ifs(filename);
@@ -335,7 +329,7 @@ bool verify_proof(const string& proof,
 
     return
         marshal_in_raw(vk, keypair_prefix + ".vk") &&
-        marshal_in(r1input, input) &&
+        marshal_in_witness(r1input, input) &&
         marshal_in_raw(pA, ifs) &&
         marshal_in_raw(pB, ifs) &&
         marshal_in_raw(pC, ifs) &&
@@ -0,0 +1,90 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "snarkfront.hpp"
+
+using namespace snarkfront;
+using namespace std;
+
+void printUsage(const char* exeName) {
+    const string
+        PAIR = " -p BN128|Edwards",
+        SYS = " -s constraint_system_file",
+        OUT = " -o output_system_file",
+        N = " -n constraints_per_file",
+        WIT = " -w witness_file",
+        XWIT = " -x output_witness_file";
+
+    cout << endl << "constraint system optimization:" << endl
+         << "  system:  " << exeName << PAIR << SYS << OUT << N << endl
+         << "  witness: " << exeName << PAIR << SYS << OUT << N << WIT << XWIT << endl;
+
+    exit(EXIT_FAILURE);
+}
+
+template <typename PAIRING>
+bool optimize(const string& sysfile,
+              const string& outfile,
+              const size_t maxSize,
+              const string& witfile,
+              const string& xwitfile)
+{
+    R1CS_optimizer<PAIRING> opt(sysfile);
+    opt.writeFiles(outfile, maxSize);
+
+    if (!witfile.empty())
+        opt.writeWitness(witfile, xwitfile);
+
+    if (!!opt) {
+        cerr << "constraints " << opt.numConstraints() << endl
+             << "variables " << opt.numVariables() << endl
+             << "pinned variables " << opt.pinnedVariables() << endl
+             << "trivial constraints " << opt.trivialConstraints() << endl
+             << "booleanity constraints " << opt.booleanityConstraints() << endl;
+    }
+
+    return !!opt;
+}
+
+int main(int argc, char *argv[])
+{
+    Getopt cmdLine(argc, argv, "psowx", "n", "");
+    if (!cmdLine || cmdLine.empty()) printUsage(argv[0]);
+
+    const auto
+        pairing = cmdLine.getString('p'),
+        sysfile = cmdLine.getString('s'),
+        outfile = cmdLine.getString('o'),
+        witfile = cmdLine.getString('w'),
+        xwitfile = cmdLine.getString('x');
+
+    const auto maxSize = cmdLine.getNumber('n');
+
+    if (!validPairingName(pairing) ||
+        sysfile.empty() ||
+        outfile.empty() ||
+        -1 == maxSize ||
+        witfile.empty() != xwitfile.empty())
+        printUsage(argv[0]);
+
+    bool ok = false;
+
+    if (pairingBN128(pairing)) {
+        // Barreto-Naehrig 128 bits
+        init_BN128();
+        ok = optimize<BN128_PAIRING>(sysfile, outfile, maxSize, witfile, xwitfile);
+
+    } else if (pairingEdwards(pairing)) {
+        // Edwards 80 bits
+        init_Edwards();
+        ok = optimize<EDWARDS_PAIRING>(sysfile, outfile, maxSize, witfile, xwitfile);
+    }
+
+    if (!ok) {
+        cerr << "ERROR" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -9,10 +9,12 @@
 #include <snarkfront/CompilePPZK_query.hpp>
 #include <snarkfront/CompilePPZK_witness.hpp>
 #include <snarkfront/CompileQAP.hpp>
+#include <snarkfront/CompileR1CS.hpp>
 #include <snarkfront/Getopt.hpp>
 
 // read and write useful types for applications
 #include <snarkfront/Serialize.hpp>
+#include <snarkfront/WitnessFile.hpp>
 
 // the basic language
 #include <snarkfront/DSL_algo.hpp>
@@ -22,6 +24,12 @@
 #include <snarkfront/DSL_ppzk.hpp>
 #include <snarkfront/DSL_utility.hpp>
 
+// build independent sub-circuits on several threads
+#include <snarkfront/ParallelR1C.hpp>
+
+// synthesize a sub-circuit once and instantiate it many times
+#include <snarkfront/SubCircuit.hpp>
+
 // progress bar for proof generation and verification
 #include <snarkfront/GenericProgressBar.hpp>
 
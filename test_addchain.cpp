@@ -0,0 +1,210 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "snarkfront.hpp"
+
+using namespace snarkfront;
+using namespace std;
+
+// Barreto-Naehrig 128 bits
+typedef BN128_FR FR;
+typedef BN128_PAIRING PAIRING;
+
+// witness satisfies the constraint system if the proof verifies
+bool proofVerifies()
+{
+    const auto key = keypair<PAIRING>();
+    const auto inp = input<PAIRING>();
+    const auto prf = proof(key);
+    return verify(key, inp, prf);
+}
+
+FR evaluate(const snarklib::R1Combination<FR>& LC,
+            const snarklib::R1Witness<FR>& witness)
+{
+    FR sum = FR::zero();
+    for (const auto& t : LC.terms()) {
+        if (! t.isVariable())
+            sum = sum + t.coeff(); // constant term
+        else if (t.index() <= witness.size())
+            sum = sum + t.coeff() * witness[t.index()];
+    }
+
+    return sum;
+}
+
+// constraints of the circuit not satisfied by the witness
+size_t unsatisfied(const snarklib::R1Witness<FR>& witness)
+{
+    size_t count = 0;
+
+    TL<R1C<FR>>::singleton()->forEachConstraint(
+        [&count, &witness] (const snarklib::R1Constraint<FR>& c) {
+            if (evaluate(c.a(), witness) * evaluate(c.b(), witness) !=
+                evaluate(c.c(), witness))
+                ++count;
+        });
+
+    return count;
+}
+
+// ceil(log2(k))
+size_t carryBits(const size_t k)
+{
+    size_t n = 0;
+    while ((size_t(1) << n) < k) ++n;
+    return n;
+}
+
+// sum of count words added one at a time (left to right) or pairwise
+// (balanced tree) must have ceil(log2(count)) carry bits, the sum must
+// agree with native arithmetic and the proof must verify
+template <typename X, typename T>
+bool checkChain(const size_t count, const T a, const bool balanced)
+{
+    reset<PAIRING>();
+
+    vector<X> x(count);
+    vector<T> v(count);
+    for (size_t i = 0; i < count; ++i) {
+        v[i] = a - T(i);
+        bless(x[i], v[i]);
+    }
+
+    end_input<PAIRING>();
+
+    X z;
+    T zv = 0;
+    if (balanced) {
+        vector<X> w = x;
+        while (w.size() > 1) {
+            vector<X> u;
+            for (size_t i = 0; i + 1 < w.size(); i += 2)
+                u.emplace_back(w[i] + w[i + 1]);
+
+            if (w.size() % 2) u.emplace_back(w.back());
+
+            w = u;
+        }
+
+        z = w[0];
+    } else {
+        z = x[0];
+        for (size_t i = 1; i < count; ++i)
+            z = z + x[i];
+    }
+
+    for (const auto& b : v) zv += b;
+
+    const size_t
+        wordBits = numeric_limits<T>::digits,
+        carry = z->splitBits().size() - wordBits;
+
+    // splits the sum
+    assert_true(z == zv);
+
+    const size_t bad = unsatisfied(witness<PAIRING>());
+
+    const bool ok =
+        carry == carryBits(count) && z->value() == zv && 0 == bad && proofVerifies();
+
+    if (! ok) {
+        cout << wordBits << " bits, " << count << " words "
+             << (balanced ? "balanced" : "left to right")
+             << ", carry bits " << carry << " expected " << carryBits(count)
+             << ", unsatisfied " << bad << endl;
+    }
+
+    return ok;
+}
+
+// selected sums keep the carry bits of the longer sum, a selected
+// product is reduced before it is added
+template <typename X, typename T>
+bool checkSelect(const T a, const bool cond)
+{
+    reset<PAIRING>();
+
+    bool_x<FR> c;
+    bless(c, cond);
+
+    vector<X> x(8);
+    vector<T> v(8);
+    for (size_t i = 0; i < 8; ++i) {
+        v[i] = a - T(i);
+        bless(x[i], v[i]);
+    }
+
+    end_input<PAIRING>();
+
+    const X
+        s = x[0] + x[1] + x[2],
+        u = ternary(c, s, X(x[5] + x[6])),
+        t = ternary(c, s, X(x[3] * x[4])),
+        z = t + u + x[7];
+
+    const T
+        sv = v[0] + v[1] + v[2],
+        uv = cond ? sv : T(v[5] + v[6]),
+        tv = cond ? sv : T(v[3] * v[4]),
+        zv = tv + uv + v[7];
+
+    const size_t
+        wordBits = numeric_limits<T>::digits,
+        carry = u->splitBits().size() - wordBits;
+
+    assert_true(z == zv);
+
+    const size_t bad = unsatisfied(witness<PAIRING>());
+
+    const bool ok =
+        carry == carryBits(3) && z->value() == zv && 0 == bad && proofVerifies();
+
+    if (! ok) {
+        cout << wordBits << " bits, select " << cond
+             << ", carry bits " << carry << " expected " << carryBits(3)
+             << ", unsatisfied " << bad << endl;
+    }
+
+    return ok;
+}
+
+template <typename X, typename T>
+bool checkType()
+{
+    // all ones are the largest carry
+    const T ones = numeric_limits<T>::max();
+
+    bool ok = true;
+
+    for (const size_t count : { 2, 3, 4, 5, 16, 17, 64, 100 }) {
+        for (const bool balanced : { false, true }) {
+            ok = checkChain<X>(count, ones, balanced) && ok;
+            ok = checkChain<X>(count, T(0x5a), balanced) && ok;
+        }
+    }
+
+    for (const bool cond : { false, true }) {
+        ok = checkSelect<X>(ones, cond) && ok;
+        ok = checkSelect<X>(T(0x5a), cond) && ok;
+    }
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    init_BN128();
+
+    bool ok = true;
+
+    ok = checkType<uint32_x<FR>, uint32_t>() && ok;
+    ok = checkType<uint64_x<FR>, uint64_t>() && ok;
+
+    cout << "test " << (ok ? "passed" : "failed") << endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,69 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "snarkfront.hpp"
+
+using namespace snarkfront;
+using namespace std;
+
+// overflow addition must agree with modulo addition and carry
+template <typename UINT_N>
+bool checkAddover(const UINT_N a, const UINT_N b)
+{
+    UINT_N high = 0, low = a;
+    addover(high, low, b);
+
+    const UINT_N sum = a + b;
+    const UINT_N carry = sum < a;
+
+    if (sum == low && carry == high) return true;
+
+    cout << "addover(" << uint64_t(a) << ", " << uint64_t(b) << ") is ("
+         << uint64_t(high) << ", " << uint64_t(low) << ") not ("
+         << uint64_t(carry) << ", " << uint64_t(sum) << ")" << endl;
+
+    return false;
+}
+
+template <typename UINT_N>
+bool checkRandom(mt19937_64& rng, const size_t count)
+{
+    bool ok = true;
+
+    // low sum of all ones before adding the last bit
+    const UINT_N ones = -1;
+    ok = checkAddover<UINT_N>(ones, 1) && ok;
+    ok = checkAddover<UINT_N>(ones - 1, 1) && ok;
+    ok = checkAddover<UINT_N>(ones, ones) && ok;
+
+    for (size_t i = 0; i < count; ++i) {
+        const UINT_N a = rng(), b = rng();
+        ok = checkAddover(a, b) && ok;
+        ok = checkAddover<UINT_N>(a, ones - a) && ok;
+        ok = checkAddover<UINT_N>(a, ones - a + 1) && ok;
+    }
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    bool ok = true;
+
+    // all octet pairs
+    for (unsigned a = 0; a < 256; ++a) {
+        for (unsigned b = 0; b < 256; ++b) {
+            ok = checkAddover<uint8_t>(a, b) && ok;
+        }
+    }
+
+    mt19937_64 rng(0);
+    ok = checkRandom<uint32_t>(rng, 100000) && ok;
+    ok = checkRandom<uint64_t>(rng, 100000) && ok;
+
+    cout << "test " << (ok ? "passed" : "failed") << endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <climits>
 #include <cstdint>
 #include <cstdlib>
@@ -110,9 +111,14 @@ bool runTest(const vector<uint8_t>& keyOctets,
 {
     reset<PAIRING>();
 
+    const auto start = chrono::steady_clock::now();
     const bool valueOK = runTest<typename PAIRING::Fr>(encMode, keyOctets, inOctets);
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
     cout << "variable count " << variable_count<PAIRING>() << endl;
 
+    cerr << "synthesis seconds " << elapsed.count() << endl;
+
     GenericProgressBar progress1(cerr), progress2(cerr, 50);
 
     cerr << "generate key pair";
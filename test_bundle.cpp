@@ -100,6 +100,9 @@ bool proofFiles(const string& treefile,
 
     if (!sysfile.empty()) write_files<PAIRING>(sysfile, sysnum);
 
+    // proof witness does not need the constraint system
+    if (sysfile.empty() && pinfile.empty()) witness_only<PAIRING>();
+
     typename ZK_PATH::DigType zkRT;
     bless(zkRT, authPath.rootHash());
 
@@ -108,7 +111,7 @@ bool proofFiles(const string& treefile,
     if (!pinfile.empty()) {
         ofstream ofs(pinfile);
         if (!ofs) return false;
-        ofs << input<PAIRING>();
+        input<PAIRING>().marshal_out_raw(ofs);
         return true;
     }
 
@@ -125,7 +128,7 @@ bool proofFiles(const string& treefile,
     if (!witfile.empty()) {
         ofstream ofs(witfile);
         if (!ofs) return false;
-        ofs << witness<PAIRING>();
+        marshal_out_witness(ofs, witness<PAIRING>());
         return true;
     }
 
@@ -63,6 +63,15 @@ $DIR/test_bundle -p $PAIRING -b $SHA_BITS -t $MERKLE -i $PROOF_INPUT
 echo generate proof witness
 $DIR/test_bundle -p $PAIRING -b $SHA_BITS -t $MERKLE -w $PROOF_WITNESS
 
+################################################################################
+# optimize constraint system (input indices do not change)
+#
+
+echo optimize constraint system
+$DIR/r1cs -p $PAIRING -s $CONSTRAINT_SYSTEM -o $CONSTRAINT_SYSTEM".opt" -n $CONSTRAINTS_PER_FILE -w $PROOF_WITNESS -x $PROOF_WITNESS".opt"
+CONSTRAINT_SYSTEM=$CONSTRAINT_SYSTEM".opt"
+PROOF_WITNESS=$PROOF_WITNESS".opt"
+
 ################################################################################
 # sample entropy for key pair
 #
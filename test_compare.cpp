@@ -0,0 +1,127 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+#include "snarkfront.hpp"
+
+using namespace snarkfront;
+using namespace std;
+
+// Barreto-Naehrig 128 bits
+typedef BN128_FR FR;
+typedef BN128_PAIRING PAIRING;
+
+// witness satisfies the constraint system if the proof verifies
+bool proofVerifies()
+{
+    const auto key = keypair<PAIRING>();
+    const auto inp = input<PAIRING>();
+    const auto prf = proof(key);
+    return verify(key, inp, prf);
+}
+
+enum class Cmp { LT, LE, GT, GE };
+
+const char* cmpName(const Cmp op)
+{
+    switch (op) {
+    case (Cmp::LT) : return "<";
+    case (Cmp::LE) : return "<=";
+    case (Cmp::GT) : return ">";
+    default : return ">=";
+    }
+}
+
+template <typename A, typename B>
+bool_x<FR> compare(const Cmp op, const A& x, const B& y)
+{
+    switch (op) {
+    case (Cmp::LT) : return x < y;
+    case (Cmp::LE) : return x <= y;
+    case (Cmp::GT) : return x > y;
+    default : return x >= y;
+    }
+}
+
+template <typename T>
+bool nativeCompare(const Cmp op, const T a, const T b)
+{
+    switch (op) {
+    case (Cmp::LT) : return a < b;
+    case (Cmp::LE) : return a <= b;
+    case (Cmp::GT) : return a > b;
+    default : return a >= b;
+    }
+}
+
+// comparison asserted to be its value must verify, asserted to be
+// the opposite must not (right side variable or constant)
+template <typename X, typename T>
+bool checkCompare(const Cmp op, const T a, const T b,
+                  const bool constRight,
+                  const bool wrongValue)
+{
+    reset<PAIRING>();
+
+    X x, y;
+    bless(x, a);
+    if (! constRight) bless(y, b);
+
+    end_input<PAIRING>();
+
+    const bool_x<FR> z = constRight ? compare(op, x, b) : compare(op, x, y);
+
+    if (nativeCompare(op, a, b) != wrongValue)
+        assert_true(z);
+    else
+        assert_false(z);
+
+    const bool ok = proofVerifies() != wrongValue;
+
+    if (! ok) {
+        cout << uint64_t(a) << " " << cmpName(op) << " "
+             << (constRight ? "constant " : "") << uint64_t(b)
+             << (wrongValue ? " wrong value accepted" : " rejected") << endl;
+    }
+
+    return ok;
+}
+
+template <typename X, typename T>
+bool checkType()
+{
+    const T ones = numeric_limits<T>::max();
+    const T values[] = { 0, 1, T(ones / 2), T(ones / 2 + 1), T(ones - 1), ones };
+
+    bool ok = true;
+
+    // every pair of boundary values, including equal ones
+    for (const T a : values) {
+        for (const T b : values) {
+            for (const Cmp op : { Cmp::LT, Cmp::LE, Cmp::GT, Cmp::GE }) {
+                for (const bool constRight : { false, true }) {
+                    ok = checkCompare<X>(op, a, b, constRight, false) && ok;
+                    ok = checkCompare<X>(op, a, b, constRight, true) && ok;
+                }
+            }
+        }
+    }
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    init_BN128();
+
+    bool ok = true;
+
+    ok = checkType<uint8_x<FR>, uint8_t>() && ok;
+    ok = checkType<uint32_x<FR>, uint32_t>() && ok;
+    ok = checkType<uint64_x<FR>, uint64_t>() && ok;
+
+    cout << "test " << (ok ? "passed" : "failed") << endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
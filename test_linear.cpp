@@ -0,0 +1,129 @@
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "snarkfront.hpp"
+
+using namespace snarkfront;
+using namespace std;
+
+// Barreto-Naehrig 128 bits
+typedef BN128_FR FR;
+typedef BN128_PAIRING PAIRING;
+
+// witness satisfies the constraint system if the proof verifies
+bool proofVerifies()
+{
+    const auto key = keypair<PAIRING>();
+    const auto inp = input<PAIRING>();
+    const auto prf = proof(key);
+    return verify(key, inp, prf);
+}
+
+// results of linear and nonlinear operations on the same inputs
+struct Results
+{
+    array<uint32_t, 3> words;
+    uint8_t octet;
+    array<FR, 2> field;
+    bool verifies;
+    size_t variables;
+};
+
+// linear results kept as combinations of at most maxTerms variables
+// (zero makes a new variable and constraint for each)
+Results circuit(const size_t maxTerms)
+{
+    reset<PAIRING>();
+    linear_combinations<PAIRING>(maxTerms);
+
+    const uint32_t av = 0x89abcdef, bv = 0x01234567;
+    const uint8_t cv = 0x5a;
+    const FR xv = FR("12345678901234567890"), yv = FR("98765432109876543210");
+
+    uint32_x<FR> a, b;
+    uint8_x<FR> c;
+    field_x<FR> x, y;
+    bless(a, av);
+    bless(b, bv);
+    bless(c, cv);
+    bless(x, xv);
+    bless(y, yv);
+
+    end_input<PAIRING>();
+
+    // complement, addition chain, subtraction
+    const uint32_x<FR>
+        w0 = ~a + (a ^ b) + (a & b) + 0x1234,
+        w1 = (w0 + ~b) * a,
+        w2 = ~(w1 + b) ^ w0;
+
+    const uint8_x<FR> u = ~(~c + c) + ~c;
+
+    const field_x<FR>
+        f0 = (x + y) * (x - y) - x,
+        f1 = f0 - (y - x) + f0 * y;
+
+    // results must agree with native arithmetic
+    const uint32_t
+        w0v = ~av + (av ^ bv) + (av & bv) + 0x1234,
+        w1v = (w0v + ~bv) * av,
+        w2v = ~(w1v + bv) ^ w0v;
+
+    const uint8_t uv = uint8_t(~uint8_t(uint8_t(~cv) + cv)) + uint8_t(~cv);
+
+    const FR
+        f0v = (xv + yv) * (xv - yv) - xv,
+        f1v = f0v - (yv - xv) + f0v * yv;
+
+    assert_true(w0 == w0v);
+    assert_true(w1 == w1v);
+    assert_true(w2 == w2v);
+    assert_true(u == uv);
+    assert_true(f0 == f0v);
+    assert_true(f1 == f1v);
+
+    Results r;
+    r.words = { w0->value(), w1->value(), w2->value() };
+    r.octet = u->value();
+    r.field = { f0->value(), f1->value() };
+    r.variables = variable_count<PAIRING>();
+    r.verifies = proofVerifies();
+
+    return r;
+}
+
+int main(int argc, char *argv[])
+{
+    init_BN128();
+
+    const Results
+        on = circuit(256),
+        off = circuit(0);
+
+    bool ok = true;
+
+    if (! on.verifies || ! off.verifies) {
+        cout << "proof with linear combinations " << on.verifies
+             << ", without " << off.verifies << endl;
+        ok = false;
+    }
+
+    if (on.words != off.words || on.octet != off.octet ||
+        on.field[0] != off.field[0] || on.field[1] != off.field[1]) {
+        cout << "values differ with and without linear combinations" << endl;
+        ok = false;
+    }
+
+    // combinations make fewer variables
+    if (on.variables >= off.variables) {
+        cout << "variables with linear combinations " << on.variables
+             << ", without " << off.variables << endl;
+        ok = false;
+    }
+
+    cout << "test " << (ok ? "passed" : "failed") << endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,100 @@
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "snarkfront.hpp"
+
+using namespace snarkfront;
+using namespace std;
+
+// Barreto-Naehrig 128 bits
+typedef BN128_FR FR;
+typedef BN128_PAIRING PAIRING;
+
+// witness satisfies the constraint system if the proof verifies
+bool proofVerifies()
+{
+    const auto key = keypair<PAIRING>();
+    const auto inp = input<PAIRING>();
+    const auto prf = proof(key);
+    return verify(key, inp, prf);
+}
+
+// look-up table and subscript of variables must both select entry idx
+// (zero if idx is N or more) and nothing else
+template <size_t N>
+bool checkIndex(const array<uint8_t, N>& a,
+                const uint8_t idx,
+                const bool wrongValue)
+{
+    reset<PAIRING>();
+
+    uint8_x<FR> x;
+    bless(x, idx);
+
+    end_input<PAIRING>();
+
+    array<uint8_x<FR>, N> v;
+    bless(v, a);
+
+    const uint8_t value = (idx < N) ? a[idx] : 0;
+    const uint8_t expected = wrongValue ? value ^ 0x1 : value;
+
+    assert_true(subscript(a, x) == expected);
+    assert_true(subscript(v, x) == expected);
+
+    const bool ok = proofVerifies() != wrongValue;
+
+    if (! ok) {
+        cout << "N " << N << " index " << static_cast<int>(idx)
+             << (wrongValue ? " wrong value accepted" : " rejected") << endl;
+    }
+
+    return ok;
+}
+
+template <size_t N>
+bool checkTable(const array<uint8_t, N>& a)
+{
+    bool ok = true;
+
+    // first and last entries, one past the end and largest index
+    for (const size_t i : { size_t(0), N / 2, N - 1, N, size_t(255) }) {
+        if (i > 255) continue;
+
+        ok = checkIndex(a, i, false) && ok;
+        ok = checkIndex(a, i, true) && ok;
+    }
+
+    return ok;
+}
+
+template <size_t N>
+array<uint8_t, N> makeTable()
+{
+    // entries past 255 differ from those 256 before (no aliasing)
+    array<uint8_t, N> a;
+    for (size_t i = 0; i < N; ++i)
+        a[i] = (7 * i * i + i / 3 + 1) & 0xff;
+
+    return a;
+}
+
+int main(int argc, char *argv[])
+{
+    init_BN128();
+
+    bool ok = true;
+
+    ok = checkTable(makeTable<1>()) && ok;
+    ok = checkTable(makeTable<5>()) && ok;
+    ok = checkTable(makeTable<256>()) && ok;
+
+    // index bits reach only the first 256 entries
+    ok = checkTable(makeTable<300>()) && ok;
+
+    cout << "test " << (ok ? "passed" : "failed") << endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,146 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "snarkfront.hpp"
+
+using namespace snarkfront;
+using namespace std;
+
+// Barreto-Naehrig 128 bits
+typedef BN128_FR FR;
+typedef BN128_PAIRING PAIRING;
+
+// witness satisfies the constraint system if the proof verifies
+bool proofVerifies()
+{
+    const auto key = keypair<PAIRING>();
+    const auto inp = input<PAIRING>();
+    const auto prf = proof(key);
+    return verify(key, inp, prf);
+}
+
+bool report(const bool ok, const char* what, const uint64_t a, const uint64_t b)
+{
+    if (! ok) cout << what << " " << a << " " << b << endl;
+    return ok;
+}
+
+// equality of words in scalar form (sums) and bit form (XOR results)
+// x == y must verify only if equal, x != y only if not equal
+template <typename X, typename T>
+bool checkEqual(const T a, const T b, const bool scalarForm)
+{
+    bool ok = true;
+
+    for (const bool notEqual : { false, true }) {
+        for (const bool assertTrue : { false, true }) {
+            // x == y is declarative (must be true)
+            if (! notEqual && ! assertTrue) continue;
+
+            reset<PAIRING>();
+
+            X x, y;
+            bless(x, a);
+            bless(y, b);
+
+            end_input<PAIRING>();
+
+            const T k = 0x5a;
+            const X
+                u = scalarForm ? X(x + k) : X(x ^ k),
+                v = scalarForm ? X(y + k) : X(y ^ k);
+
+            if (notEqual) {
+                if (assertTrue)
+                    assert_true(u != v);
+                else
+                    assert_false(u != v);
+            } else {
+                assert_true(u == v);
+            }
+
+            const bool expected = (notEqual == assertTrue) ? (a != b) : (a == b);
+
+            ok = report(proofVerifies() == expected,
+                        notEqual ? (assertTrue ? "assert_true !=" : "assert_false !=") : "assert_true ==",
+                        a, b) && ok;
+        }
+    }
+
+    return ok;
+}
+
+// select words in scalar form or bit form, result must be the chosen
+// argument and nothing else
+template <typename X, typename T>
+bool checkSelect(const T a, const T b, const bool scalarForm)
+{
+    bool ok = true;
+
+    for (const bool cond : { false, true }) {
+        for (const bool wrongValue : { false, true }) {
+            reset<PAIRING>();
+
+            bool_x<FR> c;
+            X x, y;
+            bless(c, cond);
+            bless(x, a);
+            bless(y, b);
+
+            end_input<PAIRING>();
+
+            const T k = 0x5a;
+            const X
+                u = scalarForm ? X(x + k) : X(x ^ k),
+                v = scalarForm ? X(y + k) : X(y ^ k);
+
+            const T
+                uv = scalarForm ? T(a + k) : T(a ^ k),
+                vv = scalarForm ? T(b + k) : T(b ^ k),
+                expected = cond ? uv : vv;
+
+            assert_true(ternary(c, u, v) == T(wrongValue ? expected ^ 0x1 : expected));
+
+            ok = report(proofVerifies() != wrongValue,
+                        cond ? "select true" : "select false",
+                        a, b) && ok;
+        }
+    }
+
+    return ok;
+}
+
+template <typename X, typename T>
+bool checkType()
+{
+    const T ones = -1;
+    const T values[][2] = { { 0, 0 }, { 0, 1 }, { ones, ones }, { ones, 0 },
+                            { 0x1234, 0x1235 }, { T(ones - 0x5a), T(ones - 0x5a) } };
+
+    bool ok = true;
+
+    for (const auto& p : values) {
+        for (const bool scalarForm : { false, true }) {
+            ok = checkEqual<X>(p[0], p[1], scalarForm) && ok;
+            ok = checkSelect<X>(p[0], p[1], scalarForm) && ok;
+        }
+    }
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    init_BN128();
+
+    bool ok = true;
+
+    ok = checkType<uint8_x<FR>, uint8_t>() && ok;
+    ok = checkType<uint32_x<FR>, uint32_t>() && ok;
+    ok = checkType<uint64_x<FR>, uint64_t>() && ok;
+
+    cout << "test " << (ok ? "passed" : "failed") << endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
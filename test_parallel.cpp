@@ -0,0 +1,189 @@
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "snarkfront.hpp"
+
+using namespace snarkfront;
+using namespace std;
+
+// Barreto-Naehrig 128 bits
+typedef BN128_FR FR;
+typedef BN128_PAIRING PAIRING;
+
+// witness satisfies the constraint system if the proof verifies
+bool proofVerifies()
+{
+    const auto key = keypair<PAIRING>();
+    const auto inp = input<PAIRING>();
+    const auto prf = proof(key);
+    return verify(key, inp, prf);
+}
+
+const size_t NUMBER_SUBS = 8;
+
+// same rounds in the DSL and natively
+uint32_x<FR> mix(const uint32_x<FR>& x, const uint32_x<FR>& y, const uint32_t k)
+{
+    const uint32_x<FR> a = (x + y + k) ^ ROTR(x, 7);
+    const uint32_x<FR> b = (a & y) | (~a & ROTL(y, 3));
+    return a + b * 3;
+}
+
+uint32_t mix(const uint32_t x, const uint32_t y, const uint32_t k)
+{
+    const uint32_t
+        a = (x + y + k) ^ ((x >> 7) | (x << 25)),
+        b = (a & y) | (~a & ((y << 3) | (y >> 29)));
+    return a + b * 3;
+}
+
+struct Circuit
+{
+    snarklib::R1Witness<FR> witness;
+    array<uint32_t, 2 * NUMBER_SUBS> values;
+    size_t variables;
+    bool verifies;
+};
+
+// independent sub-circuits, built on worker threads or in order on this
+// thread (no worker threads)
+void round(ParallelR1C<FR>& P,
+           const size_t numThreads,
+           const array<uint32_x<FR>, NUMBER_SUBS>& in,
+           array<uint32_x<FR>, NUMBER_SUBS>& out,
+           const uint32_t k0)
+{
+    vector<function<void ()>> subs;
+    for (size_t i = 0; i < NUMBER_SUBS; ++i) {
+        subs.emplace_back(
+            [&in, &out, i, k0] () {
+                uint32_x<FR> a = in[i];
+                for (uint32_t k = k0; k < k0 + 4; ++k)
+                    a = mix(a, in[(i + 1) % NUMBER_SUBS], k) ^ k;
+
+                out[i] = a;
+            });
+    }
+
+    if (numThreads)
+        P.synthesize(subs);
+    else
+        for (const auto& f : subs) f();
+}
+
+array<uint32_t, NUMBER_SUBS> round(const array<uint32_t, NUMBER_SUBS>& in,
+                                   const uint32_t k0)
+{
+    array<uint32_t, NUMBER_SUBS> out;
+    for (size_t i = 0; i < NUMBER_SUBS; ++i) {
+        uint32_t a = in[i];
+        for (uint32_t k = k0; k < k0 + 4; ++k)
+            a = mix(a, in[(i + 1) % NUMBER_SUBS], k) ^ k;
+
+        out[i] = a;
+    }
+
+    return out;
+}
+
+// results of sub-circuits are used before they are merged
+Circuit circuit(const size_t numThreads)
+{
+    reset<PAIRING>();
+
+    array<uint32_t, NUMBER_SUBS> v;
+    array<uint32_x<FR>, NUMBER_SUBS> x;
+    for (size_t i = 0; i < NUMBER_SUBS; ++i) {
+        v[i] = 0x9e3779b9 * (i + 1);
+        bless(x[i], v[i]);
+    }
+
+    end_input<PAIRING>();
+
+    ParallelR1C<FR> P(numThreads);
+    array<uint32_x<FR>, NUMBER_SUBS> y, z, w;
+
+    // second round uses results of the first (not merged yet)
+    round(P, numThreads, x, y, 0);
+    round(P, numThreads, y, z, 4);
+
+    const auto zv = round(round(v, 0), 4);
+    for (size_t i = 0; i < NUMBER_SUBS; ++i)
+        assert_true(z[i] == zv[i]);
+
+    if (numThreads) P.merge();
+
+    // shards after merging take new variable IDs
+    round(P, numThreads, x, w, 8);
+
+    const auto wv = round(v, 8);
+    for (size_t i = 0; i < NUMBER_SUBS; ++i)
+        assert_true(w[i] == wv[i]);
+
+    if (numThreads) P.merge();
+
+    Circuit c;
+    for (size_t i = 0; i < NUMBER_SUBS; ++i) {
+        c.values[i] = z[i]->value();
+        c.values[NUMBER_SUBS + i] = w[i]->value();
+    }
+
+    c.witness = witness<PAIRING>();
+    c.variables = variable_count<PAIRING>();
+    c.verifies = proofVerifies();
+
+    return c;
+}
+
+bool sameWitness(const Circuit& a, const Circuit& b)
+{
+    if (a.variables != b.variables || a.witness.size() != b.witness.size()) {
+        cout << "variables " << a.variables << " and " << b.variables << endl;
+        return false;
+    }
+
+    for (size_t i = 1; i <= a.witness.size(); ++i) {
+        if (a.witness[i] != b.witness[i]) {
+            cout << "witness differs at variable " << i << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    init_BN128();
+
+    const Circuit
+        seq = circuit(0),
+        one = circuit(1),
+        par = circuit(4);
+
+    bool ok = true;
+
+    if (! seq.verifies || ! one.verifies || ! par.verifies) {
+        cout << "proof sequential " << seq.verifies
+             << ", one thread " << one.verifies
+             << ", parallel " << par.verifies << endl;
+        ok = false;
+    }
+
+    if (seq.values != one.values || seq.values != par.values) {
+        cout << "values differ" << endl;
+        ok = false;
+    }
+
+    // shards split their own copies of outside variables, so only
+    // merged circuits are the same however threads were scheduled
+    ok = sameWitness(one, par) && ok;
+
+    cout << "test " << (ok ? "passed" : "failed") << endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <climits>
 #include <cstdint>
 #include <cstdlib>
@@ -212,6 +213,8 @@ bool runTest(const string& shaBits,
     bool valueOK = false;
     typedef typename PAIRING::Fr FR;
 
+    const auto start = chrono::steady_clock::now();
+
     if ("1" == shaBits) {
         valueOK = runTest<cryptl::SHA1, snarkfront::SHA1<FR>>(
             stdInput, hashOnly, hashDig, eqPattern, neqPattern);
@@ -241,11 +244,15 @@ bool runTest(const string& shaBits,
             stdInput, hashOnly, hashDig, eqPattern, neqPattern);
     }
 
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
     // special case for hash only, skip zero knowledge proof
     if (hashOnly) return valueOK;
 
     cout << "variable count " << variable_count<PAIRING>() << endl;
 
+    cerr << "synthesis seconds " << elapsed.count() << endl;
+
     GenericProgressBar progress1(cerr), progress2(cerr, 50);
 
     cerr << "generate key pair";
@@ -0,0 +1,242 @@
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "snarkfront.hpp"
+
+using namespace snarkfront;
+using namespace std;
+
+// Barreto-Naehrig 128 bits
+typedef BN128_FR FR;
+typedef BN128_PAIRING PAIRING;
+
+// witness satisfies the constraint system if the proof verifies
+bool proofVerifies()
+{
+    const auto key = keypair<PAIRING>();
+    const auto inp = input<PAIRING>();
+    const auto prf = proof(key);
+    return verify(key, inp, prf);
+}
+
+FR evaluate(const snarklib::R1Combination<FR>& LC,
+            const snarklib::R1Witness<FR>& witness)
+{
+    FR sum = FR::zero();
+    for (const auto& t : LC.terms()) {
+        if (! t.isVariable())
+            sum = sum + t.coeff(); // constant term
+        else if (t.index() <= witness.size())
+            sum = sum + t.coeff() * witness[t.index()];
+    }
+
+    return sum;
+}
+
+// constraints of the circuit not satisfied by the witness
+size_t unsatisfied(const snarklib::R1Witness<FR>& witness)
+{
+    size_t count = 0;
+
+    TL<R1C<FR>>::singleton()->forEachConstraint(
+        [&count, &witness] (const snarklib::R1Constraint<FR>& c) {
+            if (evaluate(c.a(), witness) * evaluate(c.b(), witness) !=
+                evaluate(c.c(), witness))
+                ++count;
+        });
+
+    return count;
+}
+
+typedef uint32_x<FR> W;
+
+// compression rounds: 4 state words and 4 message words in, 4 state
+// words out (some sums, some bits)
+vector<W> block(const vector<W>& in)
+{
+    W a = in[0], b = in[1], c = in[2], d = in[3];
+    for (size_t r = 0; r < 4; ++r) {
+        const W
+            ch = (a & b) ^ (~a & c),
+            t = d + ch + ROTR(a, 6) + in[4 + r],
+            mj = (a & b) ^ (a & c) ^ (b & c);
+
+        d = c;
+        c = b;
+        b = a;
+        a = t + mj;
+    }
+
+    return { a + in[0], b, c ^ in[2], d };
+}
+
+array<uint32_t, 4> nativeBlock(const array<uint32_t, 8>& in)
+{
+    uint32_t a = in[0], b = in[1], c = in[2], d = in[3];
+    for (size_t r = 0; r < 4; ++r) {
+        const uint32_t
+            ch = (a & b) ^ (~a & c),
+            t = d + ch + ((a >> 6) | (a << 26)) + in[4 + r],
+            mj = (a & b) ^ (a & c) ^ (b & c);
+
+        d = c;
+        c = b;
+        b = a;
+        a = t + mj;
+    }
+
+    return { a + in[0], b, c ^ in[2], d };
+}
+
+const size_t NUMBER_BLOCKS = 5;
+
+struct Circuit
+{
+    array<uint32_t, 4> state;
+    size_t unsat;
+    bool tape;
+    bool verifies;
+};
+
+// chain of blocks, each one's state feeds the next (instances of the
+// sub-circuit or inline DSL)
+Circuit circuit(const bool useSub, const bool wrongValue)
+{
+    reset<PAIRING>();
+    record_tape<PAIRING>();
+
+    array<uint32_t, 4> sv;
+    array<uint32_t, 4> mv;
+    vector<W> state(4), msg(4);
+    for (size_t i = 0; i < 4; ++i) {
+        sv[i] = 0x6a09e667 * (i + 1);
+        mv[i] = 0xbb67ae85 ^ (77 * i);
+        bless(state[i], sv[i]);
+        bless(msg[i], mv[i]);
+    }
+
+    end_input<PAIRING>();
+
+    const SubCircuit<W, W> S(8, block);
+
+    for (size_t k = 0; k < NUMBER_BLOCKS; ++k) {
+        vector<W> in = state;
+        in.insert(in.end(), msg.begin(), msg.end());
+        state = useSub ? S(in) : block(in);
+        msg[k % 4] = msg[k % 4] ^ state[0];
+
+        array<uint32_t, 8> inv;
+        for (size_t i = 0; i < 4; ++i) {
+            inv[i] = sv[i];
+            inv[4 + i] = mv[i];
+        }
+
+        sv = nativeBlock(inv);
+        mv[k % 4] ^= sv[0];
+    }
+
+    for (size_t i = 0; i < 4; ++i)
+        assert_true(state[i] == (wrongValue && 3 == i ? sv[i] ^ 0x1 : sv[i]));
+
+    Circuit c;
+    for (size_t i = 0; i < 4; ++i)
+        c.state[i] = state[i]->value();
+
+    const auto& tape = witness_tape<PAIRING>();
+    const auto replayed = tape.replay(tape.inputs());
+    const auto& w = witness<PAIRING>();
+
+    c.tape = (replayed.size() == w.size());
+    for (size_t i = 1; c.tape && i <= w.size(); ++i)
+        c.tape = (replayed[i] == w[i]);
+
+    c.unsat = unsatisfied(w);
+    c.verifies = proofVerifies();
+
+    return c;
+}
+
+// a variable of the calling circuit inside the sub-circuit throws, the
+// calling circuit is left as it was
+bool outsideVariable()
+{
+    reset<PAIRING>();
+
+    W x, y;
+    bless(x, 0x01234567u);
+    bless(y, 0x89abcdefu);
+
+    end_input<PAIRING>();
+
+    const W z = x + y;
+    const size_t count = variable_count<PAIRING>();
+
+    bool thrown = false;
+    try {
+        const SubCircuit<W, W> S(
+            1,
+            [&x] (const vector<W>& in) -> vector<W> {
+                return { in[0] ^ x };
+            });
+    } catch (const logic_error&) {
+        thrown = true;
+    }
+
+    const bool same = (count == variable_count<PAIRING>());
+
+    assert_true(z == 0x01234567u + 0x89abcdefu);
+
+    return thrown && same && proofVerifies();
+}
+
+int main(int argc, char *argv[])
+{
+    init_BN128();
+
+    const Circuit
+        sub = circuit(true, false),
+        dsl = circuit(false, false),
+        wrong = circuit(true, true);
+
+    bool ok = true;
+
+    if (sub.state != dsl.state) {
+        cout << "values differ with and without sub-circuit" << endl;
+        ok = false;
+    }
+
+    if (sub.unsat || dsl.unsat) {
+        cout << "unsatisfied constraints sub-circuit " << sub.unsat
+             << ", inline " << dsl.unsat << endl;
+        ok = false;
+    }
+
+    if (! sub.tape || ! dsl.tape) {
+        cout << "tape replay differs from witness" << endl;
+        ok = false;
+    }
+
+    if (! sub.verifies || ! dsl.verifies) {
+        cout << "proof with sub-circuit " << sub.verifies
+             << ", inline " << dsl.verifies << endl;
+        ok = false;
+    }
+
+    if (wrong.verifies || 0 == wrong.unsat) {
+        cout << "wrong value accepted" << endl;
+        ok = false;
+    }
+
+    if (! outsideVariable()) {
+        cout << "variable from outside the sub-circuit" << endl;
+        ok = false;
+    }
+
+    cout << "test " << (ok ? "passed" : "failed") << endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
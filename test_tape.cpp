@@ -0,0 +1,169 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "snarkfront.hpp"
+
+using namespace snarkfront;
+using namespace std;
+
+// Barreto-Naehrig 128 bits
+typedef BN128_FR FR;
+typedef BN128_PAIRING PAIRING;
+
+// witness satisfies the constraint system if the proof verifies
+bool proofVerifies()
+{
+    const auto key = keypair<PAIRING>();
+    const auto inp = input<PAIRING>();
+    const auto prf = proof(key);
+    return verify(key, inp, prf);
+}
+
+FR evaluate(const snarklib::R1Combination<FR>& LC,
+            const snarklib::R1Witness<FR>& witness)
+{
+    FR sum = FR::zero();
+    for (const auto& t : LC.terms()) {
+        if (! t.isVariable())
+            sum = sum + t.coeff(); // constant term
+        else if (t.index() <= witness.size())
+            sum = sum + t.coeff() * witness[t.index()];
+    }
+
+    return sum;
+}
+
+// constraints of the circuit not satisfied by the witness
+size_t unsatisfied(const snarklib::R1Witness<FR>& witness)
+{
+    size_t count = 0;
+
+    TL<R1C<FR>>::singleton()->forEachConstraint(
+        [&count, &witness] (const snarklib::R1Constraint<FR>& c) {
+            if (evaluate(c.a(), witness) * evaluate(c.b(), witness) !=
+                evaluate(c.c(), witness))
+                ++count;
+        });
+
+    return count;
+}
+
+bool sameWitness(const snarklib::R1Witness<FR>& a,
+                 const snarklib::R1Witness<FR>& b)
+{
+    if (a.size() != b.size()) return false;
+
+    for (size_t i = 1; i <= a.size(); ++i)
+        if (a[i] != b[i]) return false;
+
+    return true;
+}
+
+struct Inputs
+{
+    uint32_t a, b;
+    uint64_t c;
+    bool p;
+    FR x;
+};
+
+// the same constraints for any input values (nothing asserted about them)
+void circuit(const Inputs& in)
+{
+    uint32_x<FR> a, b;
+    uint64_x<FR> c;
+    bool_x<FR> p;
+    field_x<FR> x;
+    bless(a, in.a);
+    bless(b, in.b);
+    bless(c, in.c);
+    bless(p, in.p);
+    bless(x, in.x);
+
+    end_input<PAIRING>();
+
+    const uint32_x<FR>
+        s = (a + b) * 3 + ROTR(a ^ b, 7),
+        t = (s & ~a) | (b + ~s),
+        u = ternary(p && (s < t), s, t + 1);
+
+    const uint64_x<FR>
+        d = (c + (c ^ 0x0123456789abcdefULL)) * c,
+        e = ternary(d >= c, ROTL(d, 13), ~d);
+
+    const field_x<FR> y = (x + FR::one()) * inverse(x) - x * x;
+
+    // results depend on every input
+    const bool_x<FR> q = (u != 0x12345678) || (e != 0) || (y != FR::zero());
+    const uint32_x<FR> v = ternary(q, u, ~u);
+    const uint64_x<FR> w = ternary(q, e, d);
+}
+
+int main(int argc, char *argv[])
+{
+    init_BN128();
+
+    const Inputs
+        in0 = { 0x89abcdef, 0x01234567, 0xfedcba9876543210ULL, true,
+                FR("12345678901234567890") },
+        in1 = { 0x00000001, 0xffffffff, 0x0000000000000007ULL, false,
+                FR("98765432109876543210") };
+
+    bool ok = true;
+
+    // circuit recorded with the first inputs
+    reset<PAIRING>();
+    record_tape<PAIRING>();
+    circuit(in0);
+
+    const auto tape = witness_tape<PAIRING>();
+
+    if (! sameWitness(tape.replay(tape.inputs()), witness<PAIRING>())) {
+        cout << "replay of recorded inputs differs from witness" << endl;
+        ok = false;
+    }
+
+    // replay with the second inputs, blessing order
+    const vector<WitnessValue> values = {
+        WitnessValue(in1.a), WitnessValue(in1.b), WitnessValue(in1.c),
+        WitnessValue(in1.p), WitnessValue(in1.x) };
+
+    const auto replayed = tape.replay(values);
+
+    const size_t bad = unsatisfied(replayed);
+    if (bad) {
+        cout << "replayed witness leaves " << bad << " constraints unsatisfied" << endl;
+        ok = false;
+    }
+
+    // circuit synthesized with the second inputs
+    reset<PAIRING>();
+    circuit(in1);
+
+    if (! sameWitness(replayed, witness<PAIRING>())) {
+        cout << "replayed witness differs from synthesized witness" << endl;
+        ok = false;
+    }
+
+    if (! proofVerifies()) {
+        cout << "proof does not verify" << endl;
+        ok = false;
+    }
+
+    // a wrong witness must not satisfy the system
+    snarklib::R1Witness<FR> wrong;
+    for (size_t i = 1; i <= replayed.size(); ++i)
+        wrong.assignVar(snarklib::R1Variable<FR>(i),
+                        (i == replayed.size() / 2) ? replayed[i] + FR::one() : replayed[i]);
+
+    if (0 == unsatisfied(wrong)) {
+        cout << "wrong witness satisfies constraints" << endl;
+        ok = false;
+    }
+
+    cout << "test " << (ok ? "passed" : "failed") << endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -25,12 +25,6 @@ void printUsage(const char* exeName) {
     exit(EXIT_FAILURE);
 }
 
-template <typename T>
-bool marshal_in(T& a, const string& filename) {
-    ifstream ifs(filename);
-    return !!ifs && a.marshal_in(ifs);
-}
-
 template <typename T>
 bool marshal_in_raw(T& a, const string& filename) {
     ifstream ifs(filename);
@@ -55,7 +49,7 @@ bool verifyProof(const string& keyfile,
 
     return
         marshal_in_raw(vk, keyfile) &&
-        marshal_in(input, pinfile) &&
+        marshal_in_witness(input, pinfile) &&
         marshal_in_raw(pA, afile) &&
         marshal_in_raw(pB, bfile) &&
         marshal_in_raw(pC, cfile) &&